@@ -0,0 +1,466 @@
+// Headless benchmark suite for libpartikel. Runs without a window or GPU.
+//
+// Times Emitter_Update, Emitter_Burst, ParticleSystem_Update,
+// ParticleSystem_UpdateParallel, Emitter_BuildInstances (the draw list
+// preparation) and ParticleSystem_BuildDrawList(Parallel) (the same, culled
+// to a view) for a range of particle counts, emitter counts and emitter
+// configs, and prints the results as JSON to stdout.
+//
+// Usage: partikel_bench [--quick] [--counts N,N,...] [--emitters N,N,...]
+//                       [--workers N] [--configs NAME,NAME,...]
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Allocation counters, partikel.h allocates through these.
+static size_t allocations;
+static size_t frees;
+static size_t bytesAllocated;
+
+static void* countedAlloc(size_t n, size_t size) {
+    allocations++;
+    bytesAllocated += n * size;
+    return calloc(n, size);
+}
+
+static void* countedRealloc(void* p, size_t size) {
+    allocations++;
+    bytesAllocated += size;
+    return realloc(p, size);
+}
+
+static void countedFree(void* p) {
+    if (p) {
+        frees++;
+    }
+    free(p);
+}
+
+#define PARTIKEL_ALLOC(n, sz) countedAlloc(n, sz)
+#define PARTIKEL_REALLOC(p, sz) countedRealloc(p, sz)
+#define PARTIKEL_FREE(p) countedFree(p)
+#define LIBPARTIKEL_IMPLEMENTATION
+#include "../vendor/partikel.h"
+
+#define MAX_LIST 16
+#define FRAME_TIME (1.0f / 60.0f)
+
+// Now returns a monotonic timestamp in nanoseconds.
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// A named emitter setup that every benchmark runs with.
+typedef struct BenchConfig {
+    const char* name;
+    ParticleStorage storage;
+    bool (*deactivator)(Particle*);
+    float originAcceleration;
+    size_t maxParticles; // Larger counts are skipped.
+} BenchConfig;
+
+// Custom deactivator, forces the per particle update path.
+static bool deactivateOffscreen(Particle* p) {
+    return p->age > p->ttl || p->position.y > 100000.0f;
+}
+
+static const BenchConfig configs[] = {
+    {"soa", PARTICLE_STORAGE_SOA, Particle_DeactivatorAge, 0.0f, 10000000},
+    {"soa_origin_accel", PARTICLE_STORAGE_SOA, Particle_DeactivatorAge, 50.0f, 10000000},
+    {"soa_custom_deactivator", PARTICLE_STORAGE_SOA, deactivateOffscreen, 0.0f, 1000000},
+    // One heap allocation per particle, so it is capped lower.
+    {"aos", PARTICLE_STORAGE_AOS, Particle_DeactivatorAge, 0.0f, 1000000},
+};
+
+// Allocation counts of a measured section.
+typedef struct AllocStats {
+    size_t allocations;
+    size_t frees;
+    size_t bytes;
+} AllocStats;
+
+static AllocStats allocSnapshot(void) {
+    return (AllocStats){allocations, frees, bytesAllocated};
+}
+
+static AllocStats allocSince(AllocStats start) {
+    return (AllocStats){allocations - start.allocations, frees - start.frees,
+                        bytesAllocated - start.bytes};
+}
+
+// Settings parsed from the command line.
+typedef struct BenchSettings {
+    size_t counts[MAX_LIST];
+    size_t countLength;
+    size_t emitters[MAX_LIST];
+    size_t emitterLength;
+    const char* configNames[MAX_LIST];
+    size_t configLength;
+    size_t workers;
+    double particleBudget; // Particle updates per measurement.
+} BenchSettings;
+
+// Emitter config for one emitter holding up to capacity particles. The
+// emission rate keeps it close to full while particles keep dying, so the
+// update benchmarks include spawning and removal.
+static EmitterConfig emitterConfig(const BenchConfig* bench, size_t capacity) {
+    return (EmitterConfig){
+        .direction = {1.0f, 0.0f},
+        .velocity = {50.0f, 150.0f},
+        .directionAngle = {0.0f, 360.0f},
+        .velocityAngle = {-10.0f, 10.0f},
+        .offset = {0.0f, 10.0f},
+        .originAcceleration = {0.0f, bench->originAcceleration},
+        .burst = {(int)capacity, (int)capacity},
+        .capacity = capacity,
+        .emissionRate = capacity,
+        .origin = {400.0f, 300.0f},
+        .externalAcceleration = {0.0f, 50.0f},
+        .startColor = WHITE,
+        .endColor = {255, 255, 255, 0},
+        .age = {0.5f, 1.5f},
+        .blendMode = BLEND_ADDITIVE,
+        .texture = {.width = 4, .height = 4},
+        .particle_Deactivator = bench->deactivator,
+        .storage = bench->storage,
+        .seed = 1234,
+    };
+}
+
+// Frames to measure so that roughly budget particles are processed.
+static size_t framesFor(double budget, size_t particles) {
+    size_t frames = (size_t)(budget / (double)(particles > 0 ? particles : 1));
+    return frames < 3 ? 3 : frames;
+}
+
+static bool firstResult = true;
+
+// Prints one result object. particles is the average amount of particles
+// processed per frame.
+static void report(const char* benchmark, const BenchConfig* bench,
+                   size_t capacity, size_t emitterCount, size_t workers,
+                   size_t frames, double particles, double elapsed,
+                   AllocStats setup, AllocStats measured) {
+    double perFrame = elapsed / (double)frames;
+    double perParticle = particles > 0 ? perFrame / particles : 0;
+    printf("%s\n    {\"benchmark\": \"%s\", \"config\": \"%s\", "
+           "\"capacity\": %zu, \"emitters\": %zu, \"workers\": %zu, "
+           "\"frames\": %zu, \"particles\": %.0f, \"ns_per_frame\": %.1f, "
+           "\"ns_per_particle\": %.4f, \"particles_per_second\": %.0f, "
+           "\"setup_allocations\": %zu, \"setup_bytes\": %zu, "
+           "\"allocations\": %zu, \"frees\": %zu, \"bytes_allocated\": %zu}",
+           firstResult ? "" : ",", benchmark, bench->name, capacity,
+           emitterCount, workers, frames, particles, perFrame, perParticle,
+           perParticle > 0 ? 1e9 / perParticle : 0, setup.allocations,
+           setup.bytes, measured.allocations, measured.frees, measured.bytes);
+    firstResult = false;
+    fflush(stdout);
+}
+
+static void freeSystem(ParticleSystem* ps) {
+    for (size_t i = 0; i < ps->length; i++) {
+        Emitter_Free(ps->emitters[i]);
+    }
+    ParticleSystem_Free(ps);
+}
+
+// Creates a system of emitterCount emitters sharing capacity particles,
+// started and filled up to their capacity. Returns NULL on failure.
+static ParticleSystem* createSystem(const BenchConfig* bench, size_t capacity,
+                                    size_t emitterCount) {
+    ParticleSystem* ps = ParticleSystem_New();
+    if (!ps) {
+        return NULL;
+    }
+    size_t each = capacity / emitterCount;
+    for (size_t i = 0; i < emitterCount; i++) {
+        EmitterConfig config = emitterConfig(bench, each);
+        config.seed += i;
+        Emitter* emitter = ParticleSystem_NewEmitter(ps, config);
+        if (!emitter) {
+            freeSystem(ps);
+            return NULL;
+        }
+    }
+    ParticleSystem_Burst(ps);
+    ParticleSystem_Start(ps);
+    return ps;
+}
+
+// Emitter_Update on a single emitter at steady state.
+static bool benchEmitterUpdate(const BenchSettings* s, const BenchConfig* bench,
+                               size_t capacity) {
+    AllocStats setup = allocSnapshot();
+    Emitter* emitter = Emitter_New(emitterConfig(bench, capacity));
+    if (!emitter) {
+        return false;
+    }
+    Emitter_Burst(emitter);
+    Emitter_Start(emitter);
+    for (int i = 0; i < 60; i++) { // Reach the steady state.
+        Emitter_Update(emitter, FRAME_TIME);
+    }
+    setup = allocSince(setup);
+
+    size_t frames = framesFor(s->particleBudget, capacity);
+    double particles = 0;
+    AllocStats measured = allocSnapshot();
+    double start = now();
+    for (size_t f = 0; f < frames; f++) {
+        particles += (double)Emitter_Update(emitter, FRAME_TIME);
+    }
+    double elapsed = now() - start;
+    measured = allocSince(measured);
+
+    report("emitter_update", bench, capacity, 1, 1, frames,
+           particles / (double)frames, elapsed, setup, measured);
+    Emitter_Free(emitter);
+    return true;
+}
+
+// Emitter_Burst filling an empty emitter up to its capacity. Every burst
+// gets a fresh emitter, only the burst itself is timed.
+static bool benchEmitterBurst(const BenchSettings* s, const BenchConfig* bench,
+                              size_t capacity) {
+    size_t frames = framesFor(s->particleBudget / 4, capacity);
+    double elapsed = 0;
+    AllocStats setup = {0};
+    AllocStats measured = {0};
+    for (size_t f = 0; f < frames; f++) {
+        AllocStats before = allocSnapshot();
+        Emitter* emitter = Emitter_New(emitterConfig(bench, capacity));
+        if (!emitter) {
+            return false;
+        }
+        AllocStats created = allocSince(before);
+        setup.allocations += created.allocations;
+        setup.bytes += created.bytes;
+
+        before = allocSnapshot();
+        double start = now();
+        Emitter_Burst(emitter);
+        elapsed += now() - start;
+        AllocStats burst = allocSince(before);
+        measured.allocations += burst.allocations;
+        measured.frees += burst.frees;
+        measured.bytes += burst.bytes;
+
+        Emitter_Free(emitter);
+    }
+
+    report("emitter_burst", bench, capacity, 1, 1, frames, (double)capacity,
+           elapsed, setup, measured);
+    return true;
+}
+
+// ParticleSystem_Update, or ParticleSystem_UpdateParallel with a pool, on
+// emitterCount emitters sharing capacity particles.
+static bool benchSystemUpdate(const BenchSettings* s, const BenchConfig* bench,
+                              size_t capacity, size_t emitterCount,
+                              ParticleWorkerPool* pool) {
+    AllocStats setup = allocSnapshot();
+    ParticleSystem* ps = createSystem(bench, capacity, emitterCount);
+    if (!ps) {
+        return false;
+    }
+    for (int i = 0; i < 60; i++) { // Reach the steady state.
+        ParticleSystem_Update(ps, FRAME_TIME);
+    }
+    if (pool) { // Let the job list reach its final size.
+        ParticleSystem_UpdateParallel(ps, pool, FRAME_TIME);
+    }
+    setup = allocSince(setup);
+
+    size_t frames = framesFor(s->particleBudget, capacity);
+    double particles = 0;
+    AllocStats measured = allocSnapshot();
+    double start = now();
+    for (size_t f = 0; f < frames; f++) {
+        particles += (double)(pool ? ParticleSystem_UpdateParallel(ps, pool, FRAME_TIME)
+                                   : ParticleSystem_Update(ps, FRAME_TIME));
+    }
+    double elapsed = now() - start;
+    measured = allocSince(measured);
+
+    report(pool ? "system_update_parallel" : "system_update", bench, capacity,
+           emitterCount, pool ? s->workers : 1, frames,
+           particles / (double)frames, elapsed, setup, measured);
+    freeSystem(ps);
+    return true;
+}
+
+// Emitter_BuildInstances for emitterCount emitters sharing capacity
+// particles, without submitting anything to the GPU.
+static bool benchBuildInstances(const BenchSettings* s, const BenchConfig* bench,
+                                size_t capacity, size_t emitterCount) {
+    AllocStats setup = allocSnapshot();
+    ParticleSystem* ps = createSystem(bench, capacity, emitterCount);
+    if (!ps) {
+        return false;
+    }
+    ParticleSystem_Update(ps, FRAME_TIME);
+    for (size_t i = 0; i < ps->length; i++) { // Allocate the instances.
+        Emitter_BuildInstances(ps->emitters[i]);
+    }
+    setup = allocSince(setup);
+
+    size_t frames = framesFor(s->particleBudget, capacity);
+    double particles = 0;
+    AllocStats measured = allocSnapshot();
+    double start = now();
+    for (size_t f = 0; f < frames; f++) {
+        for (size_t i = 0; i < ps->length; i++) {
+            particles += (double)Emitter_BuildInstances(ps->emitters[i]);
+        }
+    }
+    double elapsed = now() - start;
+    measured = allocSince(measured);
+
+    report("build_instances", bench, capacity, emitterCount, 1, frames,
+           particles / (double)frames, elapsed, setup, measured);
+    freeSystem(ps);
+    return true;
+}
+
+// ParticleSystem_BuildDrawList, or ParticleSystem_BuildDrawListParallel with
+// a pool, culled to the upper half of an 800x600 screen, which leaves out
+// about half of the particles. Reports the particles drawn, not the culled
+// ones.
+static bool benchDrawList(const BenchSettings* s, const BenchConfig* bench,
+                          size_t capacity, size_t emitterCount,
+                          ParticleWorkerPool* pool) {
+    AllocStats setup = allocSnapshot();
+    ParticleSystem* ps = createSystem(bench, capacity, emitterCount);
+    if (!ps) {
+        return false;
+    }
+    ParticleSystem_SetView(ps, (Rectangle){0.0f, 0.0f, 800.0f, 300.0f});
+    for (int i = 0; i < 60; i++) { // Reach the steady state.
+        ParticleSystem_Update(ps, FRAME_TIME);
+    }
+    // Allocate the instances, the draw list and the jobs.
+    if (pool) {
+        ParticleSystem_BuildDrawListParallel(ps, pool);
+    } else {
+        ParticleSystem_BuildDrawList(ps);
+    }
+    setup = allocSince(setup);
+
+    size_t frames = framesFor(s->particleBudget, capacity);
+    double particles = 0;
+    AllocStats measured = allocSnapshot();
+    double start = now();
+    for (size_t f = 0; f < frames; f++) {
+        particles += (double)(pool ? ParticleSystem_BuildDrawListParallel(ps, pool)
+                                   : ParticleSystem_BuildDrawList(ps));
+    }
+    double elapsed = now() - start;
+    measured = allocSince(measured);
+
+    report(pool ? "draw_list_parallel" : "draw_list", bench, capacity,
+           emitterCount, pool ? s->workers : 1, frames,
+           particles / (double)frames, elapsed, setup, measured);
+    freeSystem(ps);
+    return true;
+}
+
+// Parses a comma separated list of sizes into out. Returns the length.
+static size_t parseSizes(char* arg, size_t* out) {
+    size_t length = 0;
+    for (char* item = strtok(arg, ","); item && length < MAX_LIST;
+         item = strtok(NULL, ",")) {
+        out[length++] = (size_t)strtod(item, NULL); // Accepts 1e6.
+    }
+    return length;
+}
+
+static bool configSelected(const BenchSettings* s, const char* name) {
+    if (s->configLength == 0) {
+        return true;
+    }
+    for (size_t i = 0; i < s->configLength; i++) {
+        if (strcmp(s->configNames[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    BenchSettings s = {
+        .counts = {100, 1000, 10000, 100000, 1000000, 10000000},
+        .countLength = 6,
+        .emitters = {1, 16},
+        .emitterLength = 2,
+        .workers = 4,
+        .particleBudget = 5e7,
+    };
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            s.particleBudget = 2e6;
+        } else if (strcmp(argv[i], "--counts") == 0 && i + 1 < argc) {
+            s.countLength = parseSizes(argv[++i], s.counts);
+        } else if (strcmp(argv[i], "--emitters") == 0 && i + 1 < argc) {
+            s.emitterLength = parseSizes(argv[++i], s.emitters);
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            s.workers = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--configs") == 0 && i + 1 < argc) {
+            for (char* name = strtok(argv[++i], ","); name && s.configLength < MAX_LIST;
+                 name = strtok(NULL, ",")) {
+                s.configNames[s.configLength++] = name;
+            }
+        } else {
+            fprintf(stderr,
+                    "Usage: %s [--quick] [--counts N,N,...] [--emitters N,N,...] "
+                    "[--workers N] [--configs NAME,NAME,...]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    ParticleWorkerPool* pool = s.workers > 1 ? ParticleWorkerPool_New(s.workers) : NULL;
+
+    printf("{\n  \"simd_width\": %d,\n  \"results\": [", PARTIKEL_SIMD_WIDTH);
+    bool ok = true;
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]) && ok; c++) {
+        const BenchConfig* bench = &configs[c];
+        if (!configSelected(&s, bench->name)) {
+            continue;
+        }
+        for (size_t n = 0; n < s.countLength && ok; n++) {
+            size_t capacity = s.counts[n];
+            if (capacity == 0 || capacity > bench->maxParticles) {
+                continue;
+            }
+            ok = benchEmitterUpdate(&s, bench, capacity) &&
+                 benchEmitterBurst(&s, bench, capacity);
+            for (size_t e = 0; e < s.emitterLength && ok; e++) {
+                size_t emitterCount = s.emitters[e];
+                if (emitterCount == 0 || emitterCount > capacity) {
+                    continue;
+                }
+                ok = benchSystemUpdate(&s, bench, capacity, emitterCount, NULL) &&
+                     (!pool || benchSystemUpdate(&s, bench, capacity, emitterCount, pool)) &&
+                     benchBuildInstances(&s, bench, capacity, emitterCount) &&
+                     benchDrawList(&s, bench, capacity, emitterCount, NULL) &&
+                     (!pool || benchDrawList(&s, bench, capacity, emitterCount, pool));
+            }
+        }
+    }
+    printf("\n  ]\n}\n");
+
+    if (pool) {
+        ParticleWorkerPool_Free(pool);
+    }
+    if (!ok) {
+        fprintf(stderr, "Failed to allocate the benchmark emitters\n");
+        return 1;
+    }
+    return 0;
+}
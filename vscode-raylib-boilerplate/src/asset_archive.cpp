@@ -0,0 +1,134 @@
+#include "asset_archive.h"
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <cstdlib>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Image AssetView::image() const {
+  return {.data = (void *)data.data(),
+          .width = (int)meta[0],
+          .height = (int)meta[1],
+          .mipmaps = 1,
+          .format = (int)meta[2]};
+}
+
+Wave AssetView::wave() const {
+  return {.frameCount = meta[0],
+          .sampleRate = meta[1],
+          .sampleSize = meta[2],
+          .channels = meta[3],
+          .data = (void *)data.data()};
+}
+
+// decodedSize returns the bytes the pixels or samples of an entry need.
+static uint64_t decodedSize(const AssetArchiveEntry &entry) {
+  const uint32_t *meta = entry.meta;
+  switch (entry.payload) {
+  case AssetPayload::Image:
+    return (uint64_t)GetPixelDataSize((int)meta[0], (int)meta[1], (int)meta[2]);
+  case AssetPayload::Wave:
+    return (uint64_t)meta[0] * meta[3] * (meta[2] / 8);
+  default:
+    return 0;
+  }
+}
+
+bool AssetArchive::open(const std::string &path) {
+  close();
+
+#if defined(_WIN32)
+  // No mapping here, the archive is read in one go.
+  int size = 0;
+  unsigned char *data = LoadFileData(path.c_str(), &size);
+  if (data == nullptr) {
+    return false;
+  }
+  base_ = data;
+  size_ = (size_t)size;
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+  void *mapped =
+      mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd); // The mapping keeps the file open.
+  if (mapped == MAP_FAILED) {
+    return false;
+  }
+  base_ = (const unsigned char *)mapped;
+  size_ = (size_t)info.st_size;
+#endif
+
+  // Validate everything once, lookups can then trust the index.
+  const auto *header = (const AssetArchiveHeader *)base_;
+  if (size_ < sizeof(AssetArchiveHeader) ||
+      header->magic != kAssetArchiveMagic ||
+      header->version != kAssetArchiveVersion ||
+      header->entryCount > (size_ - sizeof(AssetArchiveHeader)) /
+                               sizeof(AssetArchiveEntry)) {
+    TraceLog(LOG_WARNING, "Invalid asset archive %s", path.c_str());
+    close();
+    return false;
+  }
+  size_t indexEnd = sizeof(AssetArchiveHeader) +
+                    (size_t)header->entryCount * sizeof(AssetArchiveEntry);
+  entryCount_ = header->entryCount;
+  entries_ = (const AssetArchiveEntry *)(base_ + sizeof(AssetArchiveHeader));
+  names_ = (const char *)(base_ + indexEnd);
+  for (uint32_t i = 0; i < entryCount_; i++) {
+    const AssetArchiveEntry &entry = entries_[i];
+    if (indexEnd + entry.nameOffset + (size_t)entry.nameLength > size_ ||
+        entry.offset > size_ || entry.size > size_ - entry.offset ||
+        entry.size < decodedSize(entry)) {
+      TraceLog(LOG_WARNING, "Corrupt asset archive %s", path.c_str());
+      close();
+      return false;
+    }
+  }
+  return true;
+}
+
+void AssetArchive::close() {
+  if (base_ == nullptr) {
+    return;
+  }
+#if defined(_WIN32)
+  UnloadFileData((unsigned char *)base_);
+#else
+  munmap((void *)base_, size_);
+#endif
+  base_ = nullptr;
+  size_ = 0;
+  entries_ = nullptr;
+  names_ = nullptr;
+  entryCount_ = 0;
+}
+
+bool AssetArchive::find(std::string_view name, AssetView &view) const {
+  auto nameOf = [this](const AssetArchiveEntry &entry) {
+    return std::string_view(names_ + entry.nameOffset, entry.nameLength);
+  };
+  const AssetArchiveEntry *end = entries_ + entryCount_;
+  const AssetArchiveEntry *entry = std::lower_bound(
+      entries_, end, name, [&](const AssetArchiveEntry &e, std::string_view n) {
+        return nameOf(e) < n;
+      });
+  if (entry == end || nameOf(*entry) != name) {
+    return false;
+  }
+  view = {entry->payload, {base_ + entry->offset, (size_t)entry->size},
+          entry->meta};
+  return true;
+}
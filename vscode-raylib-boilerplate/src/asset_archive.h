@@ -0,0 +1,86 @@
+#pragma once
+#include "raylib.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Asset archive format, written by tools/asset_packer.cpp:
+//
+//   AssetArchiveHeader
+//   AssetArchiveEntry[entryCount], sorted by name
+//   name table, the names are not null terminated
+//   payloads, each aligned to kAssetArchiveAlignment
+//
+// A payload is either the original file or, for images and sounds packed
+// with --decode, raw RGBA pixels or PCM samples that can be handed to raylib
+// without decoding. All integers are little endian.
+
+constexpr uint32_t kAssetArchiveMagic = 0x52414b50; // "PKAR"
+constexpr uint32_t kAssetArchiveVersion = 1;
+constexpr uint64_t kAssetArchiveAlignment = 64;
+
+enum class AssetPayload : uint32_t {
+  File = 0,  // The original file contents.
+  Image = 1, // Pixels, meta is width, height, format.
+  Wave = 2,  // Samples, meta is frame count, sample rate, size, channels.
+};
+
+struct AssetArchiveHeader {
+  uint32_t magic = kAssetArchiveMagic;
+  uint32_t version = kAssetArchiveVersion;
+  uint32_t entryCount = 0;
+  uint32_t reserved = 0;
+};
+
+struct AssetArchiveEntry {
+  uint32_t nameOffset = 0; // From the start of the name table.
+  uint32_t nameLength = 0;
+  AssetPayload payload = AssetPayload::File;
+  uint32_t meta[4] = {};
+  uint32_t reserved = 0;
+  uint64_t offset = 0; // From the start of the archive.
+  uint64_t size = 0;
+};
+
+// AssetView is an entry of a mounted archive. data points into the mapped
+// archive and stays valid until it is closed.
+struct AssetView {
+  AssetPayload payload;
+  std::span<const unsigned char> data;
+  const uint32_t *meta;
+
+  // Only valid for the matching payload. The returned Image or Wave borrows
+  // data, so it must not be unloaded.
+  Image image() const;
+  Wave wave() const;
+};
+
+// AssetArchive maps an archive into memory, read only. The pages are shared
+// with other processes mapping the same file and only read from disk when
+// they are touched.
+class AssetArchive {
+public:
+  AssetArchive() = default;
+  ~AssetArchive() { close(); }
+
+  AssetArchive(const AssetArchive &) = delete;
+  AssetArchive &operator=(const AssetArchive &) = delete;
+
+  // Returns false if the file is missing or not a valid archive.
+  bool open(const std::string &path);
+  void close();
+  bool isOpen() const { return base_ != nullptr; }
+
+  // Looks up an entry by its name, the path relative to the packed
+  // directory. Returns false if there is none.
+  bool find(std::string_view name, AssetView &view) const;
+
+private:
+  const unsigned char *base_ = nullptr;
+  size_t size_ = 0;
+  const AssetArchiveEntry *entries_ = nullptr;
+  const char *names_ = nullptr;
+  uint32_t entryCount_ = 0;
+};
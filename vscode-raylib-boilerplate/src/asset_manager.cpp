@@ -0,0 +1,402 @@
+#include "asset_manager.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+namespace {
+
+// Bump when the layout of the cache files changes.
+constexpr uint32_t kCacheVersion = 1;
+constexpr uint32_t kCacheMagic = 0x48434b41; // "AKCH"
+
+// CacheHeader precedes the raw pixels or samples in a cache file.
+struct CacheHeader {
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  int32_t a = 0; // Image width, or wave frame count.
+  int32_t b = 0; // Image height, or wave sample rate.
+  int32_t c = 0; // Image format, or wave sample size.
+  int32_t d = 0; // Wave channels.
+  uint64_t size = 0;
+};
+
+// fnv1a hashes the contents of a file.
+uint64_t fnv1a(const unsigned char *data, size_t size) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ data[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+std::string cacheName(uint64_t hash) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)hash);
+  return name;
+}
+
+size_t waveSize(const Wave &wave) {
+  return (size_t)wave.frameCount * wave.channels * (wave.sampleSize / 8);
+}
+
+} // namespace
+
+AssetManager::AssetManager(std::filesystem::path cacheDirectory,
+                           unsigned threads)
+    : cacheDirectory_(std::move(cacheDirectory)) {
+  if (!cacheDirectory_.empty()) {
+    std::error_code error;
+    std::filesystem::create_directories(cacheDirectory_, error);
+    if (error) {
+      TraceLog(LOG_WARNING, "Asset cache disabled, cannot create %s",
+               cacheDirectory_.string().c_str());
+      cacheDirectory_.clear();
+    }
+  }
+
+  if (threads == 0) {
+    threads = std::clamp(std::thread::hardware_concurrency(), 2u, 8u) - 1;
+  }
+  for (unsigned i = 0; i < threads; i++) {
+    workers_.emplace_back([this](std::stop_token stop) { work(stop); });
+  }
+}
+
+AssetManager::~AssetManager() {
+  for (std::jthread &worker : workers_) {
+    worker.request_stop();
+  }
+  wake_.notify_all();
+  workers_.clear();
+  unloadAll();
+}
+
+TextureHandle AssetManager::loadTexture(const std::string &path) {
+  return {request(Kind::Texture, path)};
+}
+
+SoundHandle AssetManager::loadSound(const std::string &path) {
+  return {request(Kind::Sound, path)};
+}
+
+ImageHandle AssetManager::loadImage(const std::string &path) {
+  return {request(Kind::Image, path)};
+}
+
+bool AssetManager::mount(const std::string &archivePath,
+                         const std::string &rootDirectory) {
+  if (!archive_.open(archivePath)) {
+    TraceLog(LOG_INFO, "No asset archive at %s, loading loose files",
+             archivePath.c_str());
+    return false;
+  }
+  archiveRoot_ = rootDirectory;
+  return true;
+}
+
+bool AssetManager::findArchived(const std::string &path,
+                                AssetView &view) const {
+  if (!archive_.isOpen()) {
+    return false;
+  }
+  std::filesystem::path name =
+      std::filesystem::path(path).lexically_relative(archiveRoot_);
+  if (name.empty() || *name.begin() == "..") {
+    return false;
+  }
+  return archive_.find(name.generic_string(), view);
+}
+
+uint32_t AssetManager::request(Kind kind, const std::string &path) {
+  std::string key = (char)('0' + (int)kind) + path;
+  if (auto found = byPath_.find(key); found != byPath_.end()) {
+    return found->second;
+  }
+  uint32_t index = (uint32_t)assets_.size();
+  Asset &asset = assets_.emplace_back();
+  asset.kind = kind;
+  asset.path = path;
+  byPath_.emplace(std::move(key), index);
+  loading_++;
+
+  AssetView view;
+  if (findArchived(path, view)) {
+    if (view.payload == AssetPayload::File) {
+      asset.archived = view.data;
+    } else {
+      // Pre-decoded, nothing left for a worker to do.
+      if (kind != Kind::Sound && view.payload == AssetPayload::Image) {
+        asset.image = view.image();
+        asset.decoded = true;
+      } else if (kind == Kind::Sound && view.payload == AssetPayload::Wave) {
+        asset.wave = view.wave();
+        asset.decoded = true;
+      }
+      asset.borrowed = true;
+      std::lock_guard lock(mutex_);
+      completed_.push_back(&asset);
+      return index;
+    }
+  }
+
+  {
+    std::lock_guard lock(mutex_);
+    queued_.push_back(&asset);
+  }
+  wake_.notify_one();
+  return index;
+}
+
+void AssetManager::update() {
+  std::vector<Asset *> completed;
+  {
+    std::lock_guard lock(mutex_);
+    completed.swap(completed_);
+  }
+
+  for (Asset *asset : completed) {
+    if (asset->kind == Kind::Texture && asset->decoded) {
+      asset->texture = LoadTextureFromImage(asset->image);
+      if (!asset->borrowed) {
+        UnloadImage(asset->image);
+      }
+      asset->image = {};
+      asset->state = asset->texture.id > 0 ? State::Ready : State::Failed;
+    } else if (asset->kind == Kind::Sound && asset->decoded) {
+      asset->sound = LoadSoundFromWave(asset->wave);
+      if (!asset->borrowed) {
+        UnloadWave(asset->wave);
+      }
+      asset->wave = {};
+      asset->state = asset->sound.frameCount > 0 ? State::Ready : State::Failed;
+    } else if (asset->kind == Kind::Image && asset->decoded) {
+      asset->state = State::Ready; // Stays in memory, nothing to upload.
+    } else {
+      asset->state = State::Failed;
+    }
+    if (asset->state == State::Failed) {
+      TraceLog(LOG_WARNING, "Failed to load asset %s", asset->path.c_str());
+    }
+    loading_--;
+  }
+}
+
+bool AssetManager::ready(TextureHandle handle) const {
+  return assets_[handle.index].state == State::Ready;
+}
+
+bool AssetManager::ready(SoundHandle handle) const {
+  return assets_[handle.index].state == State::Ready;
+}
+
+bool AssetManager::ready(ImageHandle handle) const {
+  return assets_[handle.index].state == State::Ready;
+}
+
+// The fields of an asset that is not ready may still be written by a
+// worker, so they are only handed out once it is.
+
+const Texture2D &AssetManager::texture(TextureHandle handle) const {
+  static const Texture2D empty{};
+  const Asset &asset = assets_[handle.index];
+  return asset.state == State::Ready ? asset.texture : empty;
+}
+
+const Sound &AssetManager::sound(SoundHandle handle) const {
+  static const Sound empty{};
+  const Asset &asset = assets_[handle.index];
+  return asset.state == State::Ready ? asset.sound : empty;
+}
+
+const Image &AssetManager::image(ImageHandle handle) const {
+  static const Image empty{};
+  const Asset &asset = assets_[handle.index];
+  return asset.state == State::Ready ? asset.image : empty;
+}
+
+void AssetManager::unloadAll() {
+  {
+    // Workers may still decode, wait for them before freeing their assets.
+    std::unique_lock lock(mutex_);
+    queued_.clear();
+    done_.wait(lock, [this] { return decoding_ == 0; });
+    completed_.clear();
+  }
+
+  for (Asset &asset : assets_) {
+    if (asset.state == State::Ready) {
+      if (asset.kind == Kind::Texture) {
+        UnloadTexture(asset.texture);
+      } else if (asset.kind == Kind::Sound) {
+        UnloadSound(asset.sound);
+      } else if (!asset.borrowed) {
+        UnloadImage(asset.image);
+      }
+    } else if (asset.decoded && !asset.borrowed) {
+      // Decoded, but never uploaded.
+      UnloadImage(asset.image);
+      UnloadWave(asset.wave);
+    }
+  }
+  assets_.clear();
+  byPath_.clear();
+  loading_ = 0;
+}
+
+void AssetManager::work(std::stop_token stop) {
+  while (true) {
+    Asset *asset;
+    {
+      std::unique_lock lock(mutex_);
+      if (!wake_.wait(lock, stop, [this] { return !queued_.empty(); })) {
+        return;
+      }
+      asset = queued_.front();
+      queued_.erase(queued_.begin());
+      decoding_++;
+    }
+
+    decode(*asset);
+
+    {
+      std::lock_guard lock(mutex_);
+      completed_.push_back(asset);
+      decoding_--;
+    }
+    done_.notify_all();
+  }
+}
+
+// Reads and decodes the asset file, or takes the decoded data from the
+// cache if the file contents did not change.
+void AssetManager::decode(Asset &asset) {
+  PROFILE_ZONE("decode asset");
+  // Files in the archive are already mapped, the rest is read here.
+  unsigned char *file = nullptr;
+  const unsigned char *data = asset.archived.data();
+  int size = (int)asset.archived.size();
+  if (asset.archived.empty()) {
+    file = LoadFileData(asset.path.c_str(), &size);
+    if (file == nullptr) {
+      return;
+    }
+    data = file;
+  }
+
+  uint64_t hash = fnv1a(data, (size_t)size);
+  if (!cacheDirectory_.empty() && readCache(asset, hash)) {
+    UnloadFileData(file);
+    asset.decoded = true;
+    return;
+  }
+
+  const char *extension = GetFileExtension(asset.path.c_str());
+  if (asset.kind != Kind::Sound) {
+    asset.image = LoadImageFromMemory(extension, data, size);
+    asset.decoded = asset.image.data != nullptr;
+  } else {
+    asset.wave = LoadWaveFromMemory(extension, data, size);
+    asset.decoded = asset.wave.data != nullptr;
+  }
+  UnloadFileData(file);
+
+  if (asset.decoded && !cacheDirectory_.empty()) {
+    writeCache(asset, hash);
+  }
+}
+
+bool AssetManager::readCache(Asset &asset, uint64_t hash) {
+  std::ifstream file(cacheDirectory_ / cacheName(hash), std::ios::binary);
+  CacheHeader header{};
+  if (!file.read((char *)&header, sizeof(header)) ||
+      header.magic != kCacheMagic || header.version != kCacheVersion) {
+    return false;
+  }
+
+  // Only accept a payload that exactly fits the described pixels or samples,
+  // so a corrupt header cannot hand out an undersized buffer.
+  uint64_t expected;
+  if (asset.kind != Kind::Sound) {
+    expected = header.a > 0 && header.b > 0
+                   ? (uint64_t)GetPixelDataSize(header.a, header.b, header.c)
+                   : 0;
+  } else {
+    expected = waveSize({.frameCount = (unsigned int)header.a,
+                         .sampleRate = (unsigned int)header.b,
+                         .sampleSize = (unsigned int)header.c,
+                         .channels = (unsigned int)header.d,
+                         .data = nullptr});
+  }
+  if (expected == 0 || header.size != expected ||
+      header.size > std::numeric_limits<unsigned int>::max()) {
+    return false;
+  }
+
+  // Allocated with raylib's allocator, so UnloadImage/UnloadWave free it.
+  void *payload = MemAlloc((unsigned int)header.size);
+  if (payload == nullptr ||
+      !file.read((char *)payload, (std::streamsize)header.size)) {
+    MemFree(payload);
+    return false;
+  }
+
+  if (asset.kind != Kind::Sound) {
+    asset.image = {.data = payload,
+                   .width = header.a,
+                   .height = header.b,
+                   .mipmaps = 1,
+                   .format = header.c};
+  } else {
+    asset.wave = {.frameCount = (unsigned int)header.a,
+                  .sampleRate = (unsigned int)header.b,
+                  .sampleSize = (unsigned int)header.c,
+                  .channels = (unsigned int)header.d,
+                  .data = payload};
+  }
+  return true;
+}
+
+// Writes to a temporary file first, so a concurrent or interrupted run
+// never sees a partial cache file.
+void AssetManager::writeCache(const Asset &asset, uint64_t hash) {
+  CacheHeader header{.magic = kCacheMagic, .version = kCacheVersion};
+  const void *payload;
+  if (asset.kind != Kind::Sound) {
+    if (asset.image.mipmaps != 1) {
+      return;
+    }
+    header.a = asset.image.width;
+    header.b = asset.image.height;
+    header.c = asset.image.format;
+    header.size = (uint64_t)GetPixelDataSize(
+        asset.image.width, asset.image.height, asset.image.format);
+    payload = asset.image.data;
+  } else {
+    header.a = (int32_t)asset.wave.frameCount;
+    header.b = (int32_t)asset.wave.sampleRate;
+    header.c = (int32_t)asset.wave.sampleSize;
+    header.d = (int32_t)asset.wave.channels;
+    header.size = waveSize(asset.wave);
+    payload = asset.wave.data;
+  }
+
+  std::filesystem::path path = cacheDirectory_ / cacheName(hash);
+  std::filesystem::path temporary = path;
+  temporary += "." + std::to_string(std::hash<std::thread::id>{}(
+                         std::this_thread::get_id()));
+  bool written;
+  {
+    std::ofstream file(temporary, std::ios::binary);
+    file.write((const char *)&header, sizeof(header));
+    file.write((const char *)payload, (std::streamsize)header.size);
+    written = (bool)file;
+  }
+  std::error_code error;
+  if (written) {
+    std::filesystem::rename(temporary, path, error);
+  } else {
+    std::filesystem::remove(temporary, error);
+  }
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "asset_archive.h"
+#include "raylib.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Handles to assets of an AssetManager. They stay valid for the lifetime of
+// the manager and resolve once the asset is ready.
+struct TextureHandle {
+  uint32_t index;
+};
+struct SoundHandle {
+  uint32_t index;
+};
+struct ImageHandle {
+  uint32_t index;
+};
+
+// AssetManager loads textures, images and sounds in the background. Image and audio
+// files are read and decoded on worker threads with raylib's loaders, the
+// upload to the GPU and audio device happens on the main thread in update().
+// Images stay in memory, e.g. to be packed into a TextureAtlas.
+//
+// Decoded pixels and samples are cached in cacheDirectory, keyed by a hash
+// of the file contents, so later starts skip PNG and WAV decoding. An empty
+// cacheDirectory disables the cache.
+//
+// With an archive mounted, files below its root directory are taken from the
+// archive instead. Pre-decoded images and sounds go straight to the upload,
+// without a copy or a worker.
+class AssetManager {
+public:
+  explicit AssetManager(std::filesystem::path cacheDirectory = {},
+                        unsigned threads = 0);
+  ~AssetManager();
+
+  AssetManager(const AssetManager &) = delete;
+  AssetManager &operator=(const AssetManager &) = delete;
+
+  // Maps the archive made by tools/asset_packer from the files in
+  // rootDirectory. Returns false, and keeps loading the loose files, if it
+  // cannot be opened. Mount before requesting any asset.
+  bool mount(const std::string &archivePath, const std::string &rootDirectory);
+
+  // Starts loading the file at path. Requesting the same path as the same
+  // kind of asset again returns the same handle.
+  TextureHandle loadTexture(const std::string &path);
+  SoundHandle loadSound(const std::string &path);
+  ImageHandle loadImage(const std::string &path);
+
+  // Uploads the assets that finished decoding. Call once per frame on the
+  // main thread.
+  void update();
+
+  // True once nothing is loading anymore, failed assets included.
+  bool idle() const { return loading_ == 0; }
+
+  bool ready(TextureHandle handle) const;
+  bool ready(SoundHandle handle) const;
+  bool ready(ImageHandle handle) const;
+
+  // The asset, or an empty one while it is loading or if it failed.
+  const Texture2D &texture(TextureHandle handle) const;
+  const Sound &sound(SoundHandle handle) const;
+  const Image &image(ImageHandle handle) const;
+
+  // Unloads all assets. Must be called before the window and audio device
+  // are closed, if the manager outlives them.
+  void unloadAll();
+
+private:
+  enum class Kind { Texture, Sound, Image };
+  enum class State { Loading, Ready, Failed };
+
+  struct Asset {
+    Kind kind;
+    std::string path;
+    State state = State::Loading;
+    // Written by a worker, read by update() after it was completed.
+    bool decoded = false;
+    // image or wave point into the archive, they are not unloaded.
+    bool borrowed = false;
+    // The file contents, if it is in the archive but not pre-decoded.
+    std::span<const unsigned char> archived;
+    Image image{};
+    Wave wave{};
+    // Main thread only
+    Texture2D texture{};
+    Sound sound{};
+  };
+
+  uint32_t request(Kind kind, const std::string &path);
+  bool findArchived(const std::string &path, AssetView &view) const;
+  void work(std::stop_token stop);
+  void decode(Asset &asset);
+  bool readCache(Asset &asset, uint64_t hash);
+  void writeCache(const Asset &asset, uint64_t hash);
+
+  std::filesystem::path cacheDirectory_;
+  AssetArchive archive_;
+  std::filesystem::path archiveRoot_;
+  std::deque<Asset> assets_; // Deque, so workers keep valid references.
+  std::unordered_map<std::string, uint32_t> byPath_; // Kind, then path.
+  size_t loading_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable_any wake_;
+  std::condition_variable done_;
+  std::vector<Asset *> queued_;    // Waiting for a worker.
+  std::vector<Asset *> completed_; // Decoded, waiting for update().
+  size_t decoding_ = 0;            // Taken by a worker.
+  std::vector<std::jthread> workers_;
+};
@@ -0,0 +1,335 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+// The easing curves of vendor/reasings.h, normalized to t in [0, 1] with
+// f(0) = 0 and f(1) = 1, for animating many values at once:
+//
+//   ease<Ease::ElasticOut>(t)          constexpr, the curve is inlined
+//   ease(Ease::ElasticOut, t)          the curve chosen at runtime
+//   ease<Ease::ElasticOut>(ts, out)    a whole span, vectorizes
+//   EasingTable(Ease::ElasticOut)      a baked table with a bounded error
+//
+// The Penner form of reasings, EaseXxx(t, b, c, d), is b + c * ease(t / d).
+// Instead of sinf() and powf(), which keep loops from vectorizing, the
+// curves use the polynomials in easing_math. They agree with reasings to
+// within about 1e-6.
+
+enum class Ease : uint8_t {
+  Linear,
+  SineIn,
+  SineOut,
+  SineInOut,
+  CircIn,
+  CircOut,
+  CircInOut,
+  CubicIn,
+  CubicOut,
+  CubicInOut,
+  QuadIn,
+  QuadOut,
+  QuadInOut,
+  ExpoIn,
+  ExpoOut,
+  ExpoInOut,
+  BackIn,
+  BackOut,
+  BackInOut,
+  BounceIn,
+  BounceOut,
+  BounceInOut,
+  ElasticIn,
+  ElasticOut,
+  ElasticInOut,
+  Count
+};
+
+namespace easing_math {
+
+constexpr float kPi = 3.14159265358979323846f;
+
+// floor for the range of int, without a library call.
+constexpr float floor(float x) {
+  float i = (float)(int)x;
+  return i > x ? i - 1.0f : i;
+}
+
+// sin, with an error below 1e-6 for |x| < 100.
+constexpr float sin(float x) {
+  // Reduce to [-pi, pi] with 2 pi split in two parts, so that k * 2 pi is
+  // exact for the first part, then mirror to [-pi/2, pi/2].
+  float k = floor(x * (0.5f / kPi) + 0.5f);
+  x = (x - k * 6.28125f) - k * 1.9353071795864769e-3f;
+  x = x > kPi / 2 ? kPi - x : x;
+  x = x < -kPi / 2 ? -kPi - x : x;
+  float x2 = x * x;
+  return x * (1.0f +
+              x2 * (-1.0f / 6 +
+                    x2 * (1.0f / 120 +
+                          x2 * (-1.0f / 5040 +
+                                x2 * (1.0f / 362880 +
+                                      x2 * (-1.0f / 39916800))))));
+}
+
+constexpr float cos(float x) { return sin(x + kPi / 2); }
+
+// 2^x, with a relative error below 2e-7 for x in [-126, 127].
+constexpr float exp2(float x) {
+  float i = floor(x + 0.5f);
+  float f = x - i;
+  // Taylor series of e^(f ln 2), for f in [-0.5, 0.5].
+  float p =
+      1.0f +
+      f * (0.693147181f +
+           f * (0.240226507f +
+                f * (0.0555041087f +
+                     f * (0.00961812911f +
+                          f * (0.00133335581f + f * 0.000154035304f)))));
+  return p * std::bit_cast<float>((uint32_t)((int)i + 127) << 23);
+}
+
+constexpr float sqrt(float x) {
+  if consteval {
+    // Newton's method, only for evaluating curves at compile time.
+    if (x <= 0.0f) {
+      return 0.0f;
+    }
+    float r = x > 1.0f ? x : 1.0f;
+    for (int i = 0; i < 32; i++) {
+      r = 0.5f * (r + x / r);
+    }
+    return r;
+  } else {
+    return std::sqrt(x);
+  }
+}
+
+constexpr float bounceOut(float t) {
+  float a = 7.5625f * t * t;
+  float b = t - 1.5f / 2.75f;
+  b = 7.5625f * b * b + 0.75f;
+  float c = t - 2.25f / 2.75f;
+  c = 7.5625f * c * c + 0.9375f;
+  float d = t - 2.625f / 2.75f;
+  d = 7.5625f * d * d + 0.984375f;
+  return t < 1.0f / 2.75f   ? a
+         : t < 2.0f / 2.75f ? b
+         : t < 2.5f / 2.75f ? c
+                            : d;
+}
+
+// Keeps the exact end points of reasings, which some curves only reach
+// approximately.
+constexpr float pinEnds(float t, float value) {
+  return (t == 0.0f) | (t == 1.0f) ? t : value;
+}
+
+} // namespace easing_math
+
+// Evaluates curve E at t in [0, 1]. The pieces of a curve are all
+// evaluated and then selected, so that loops over them have no branches.
+template <Ease E> constexpr float ease(float t) {
+  namespace m = easing_math;
+  constexpr float kBack = 1.70158f;
+  constexpr float kBackInOut = kBack * 1.525f;
+  constexpr float kElastic = 2.0f * m::kPi / 0.3f;
+  constexpr float kElasticInOut = 2.0f * m::kPi / 0.45f;
+
+  if constexpr (E == Ease::Linear) {
+    return t;
+  } else if constexpr (E == Ease::SineIn) {
+    return 1.0f - m::cos(t * (m::kPi / 2));
+  } else if constexpr (E == Ease::SineOut) {
+    return m::sin(t * (m::kPi / 2));
+  } else if constexpr (E == Ease::SineInOut) {
+    return 0.5f - 0.5f * m::cos(m::kPi * t);
+  } else if constexpr (E == Ease::CircIn) {
+    return 1.0f - m::sqrt(1.0f - t * t);
+  } else if constexpr (E == Ease::CircOut) {
+    float u = t - 1.0f;
+    return m::sqrt(1.0f - u * u);
+  } else if constexpr (E == Ease::CircInOut) {
+    float u = 2.0f * t;
+    float v = u < 1.0f ? u : u - 2.0f;
+    float root = 0.5f * m::sqrt(1.0f - v * v);
+    return u < 1.0f ? 0.5f - root : 0.5f + root;
+  } else if constexpr (E == Ease::CubicIn) {
+    return t * t * t;
+  } else if constexpr (E == Ease::CubicOut) {
+    float u = t - 1.0f;
+    return u * u * u + 1.0f;
+  } else if constexpr (E == Ease::CubicInOut) {
+    float u = 2.0f * t;
+    float v = u < 1.0f ? u : u - 2.0f;
+    return u < 1.0f ? 0.5f * v * v * v : 0.5f * (v * v * v + 2.0f);
+  } else if constexpr (E == Ease::QuadIn) {
+    return t * t;
+  } else if constexpr (E == Ease::QuadOut) {
+    return -t * (t - 2.0f);
+  } else if constexpr (E == Ease::QuadInOut) {
+    float u = 2.0f * t;
+    return u < 1.0f ? 0.5f * u * u : -0.5f * ((u - 1.0f) * (u - 3.0f) - 1.0f);
+  } else if constexpr (E == Ease::ExpoIn) {
+    float value = m::exp2(10.0f * (t - 1.0f));
+    return t == 0.0f ? 0.0f : value;
+  } else if constexpr (E == Ease::ExpoOut) {
+    float value = 1.0f - m::exp2(-10.0f * t);
+    return t == 1.0f ? 1.0f : value;
+  } else if constexpr (E == Ease::ExpoInOut) {
+    float u = 2.0f * t - 1.0f;
+    float half = 0.5f * m::exp2(u < 0.0f ? 10.0f * u : -10.0f * u);
+    return m::pinEnds(t, u < 0.0f ? half : 1.0f - half);
+  } else if constexpr (E == Ease::BackIn) {
+    return t * t * ((kBack + 1.0f) * t - kBack);
+  } else if constexpr (E == Ease::BackOut) {
+    float u = t - 1.0f;
+    return u * u * ((kBack + 1.0f) * u + kBack) + 1.0f;
+  } else if constexpr (E == Ease::BackInOut) {
+    float u = 2.0f * t;
+    float v = u < 1.0f ? u : u - 2.0f;
+    float s = u < 1.0f ? -kBackInOut : kBackInOut;
+    return 0.5f * v * v * ((kBackInOut + 1.0f) * v + s) +
+           (u < 1.0f ? 0.0f : 1.0f);
+  } else if constexpr (E == Ease::BounceIn) {
+    return 1.0f - m::bounceOut(1.0f - t);
+  } else if constexpr (E == Ease::BounceOut) {
+    return m::bounceOut(t);
+  } else if constexpr (E == Ease::BounceInOut) {
+    float bounce = 0.5f * m::bounceOut(t < 0.5f ? 1.0f - 2.0f * t
+                                                : 2.0f * t - 1.0f);
+    return t < 0.5f ? 0.5f - bounce : 0.5f + bounce;
+  } else if constexpr (E == Ease::ElasticIn) {
+    float u = t - 1.0f;
+    return m::pinEnds(t,
+                      -m::exp2(10.0f * u) * m::sin((u - 0.075f) * kElastic));
+  } else if constexpr (E == Ease::ElasticOut) {
+    return m::pinEnds(
+        t, m::exp2(-10.0f * t) * m::sin((t - 0.075f) * kElastic) + 1.0f);
+  } else if constexpr (E == Ease::ElasticInOut) {
+    float u = 2.0f * t - 1.0f;
+    float wave = 0.5f * m::sin((u - 0.1125f) * kElasticInOut) *
+                 m::exp2(-10.0f * std::abs(u));
+    float value = u < 0.0f ? -wave : wave + 1.0f;
+    return m::pinEnds(t, value);
+  } else {
+    static_assert(E != E, "Unknown easing curve");
+  }
+}
+
+static_assert(ease<Ease::QuadIn>(0.5f) == 0.25f);
+static_assert(ease<Ease::ElasticOut>(0.0f) == 0.0f);
+static_assert(ease<Ease::BounceOut>(1.0f) == 1.0f);
+
+// Evaluates curve E at every t in ts, clamped to [0, 1], into out. out may
+// be ts itself.
+template <Ease E>
+void ease(std::span<const float> ts, std::span<float> out) {
+  size_t n = std::min(ts.size(), out.size());
+  const float *t = ts.data();
+  float *o = out.data();
+  // Clamping in a separate pass, GCC does not vectorize the curves that
+  // select their end points otherwise.
+  for (size_t i = 0; i < n; i++) {
+    o[i] = std::min(std::max(t[i], 0.0f), 1.0f);
+  }
+  for (size_t i = 0; i < n; i++) {
+    o[i] = ease<E>(o[i]);
+  }
+}
+
+namespace easing_math {
+
+template <size_t... I>
+constexpr auto curves(std::index_sequence<I...>) {
+  return std::array{static_cast<float (*)(float)>(&ease<(Ease)I>)...};
+}
+
+template <size_t... I>
+constexpr auto batches(std::index_sequence<I...>) {
+  return std::array{
+      static_cast<void (*)(std::span<const float>, std::span<float>)>(
+          &ease<(Ease)I>)...};
+}
+
+constexpr auto kCurves =
+    curves(std::make_index_sequence<(size_t)Ease::Count>());
+constexpr auto kBatches =
+    batches(std::make_index_sequence<(size_t)Ease::Count>());
+
+} // namespace easing_math
+
+// Evaluates the curve chosen at runtime. For many values, prefer the span
+// version, which picks the curve once per batch.
+constexpr float ease(Ease curve, float t) {
+  return easing_math::kCurves[(size_t)curve](t);
+}
+
+inline void ease(Ease curve, std::span<const float> ts, std::span<float> out) {
+  easing_math::kBatches[(size_t)curve](ts, out);
+}
+
+// EasingTable is a curve sampled at evenly spaced points and evaluated by
+// linear interpolation: one multiply, two loads and a lerp for any curve.
+// The sample count is the smallest power of two that keeps the error below
+// maxError, up to maxSamples. The Circ curves, which are vertical at an end,
+// do not get there. maxError() tells the error that was reached.
+class EasingTable {
+public:
+  explicit EasingTable(Ease curve, float maxError = 1e-3f,
+                       size_t maxSamples = 1 << 16) {
+    for (size_t intervals = 16;; intervals *= 2) {
+      samples_.resize(intervals + 1);
+      for (size_t i = 0; i <= intervals; i++) {
+        samples_[i] = ease(curve, (float)i / intervals);
+      }
+      scale_ = (float)intervals;
+      error_ = measureError(curve);
+      if (error_ <= maxError || intervals * 2 + 1 > maxSamples) {
+        return;
+      }
+    }
+  }
+
+  float operator()(float t) const {
+    float x = std::clamp(t, 0.0f, 1.0f) * scale_;
+    size_t i = std::min((size_t)x, samples_.size() - 2);
+    float f = x - (float)i;
+    return samples_[i] + (samples_[i + 1] - samples_[i]) * f;
+  }
+
+  void operator()(std::span<const float> ts, std::span<float> out) const {
+    size_t n = std::min(ts.size(), out.size());
+    for (size_t i = 0; i < n; i++) {
+      out[i] = (*this)(ts[i]);
+    }
+  }
+
+  // The largest difference to the curve found between the samples.
+  float maxError() const { return error_; }
+  size_t size() const { return samples_.size(); }
+
+private:
+  float measureError(Ease curve) const {
+    constexpr int kChecks = 8; // Points checked per interval.
+    float error = 0.0f;
+    size_t intervals = samples_.size() - 1;
+    for (size_t i = 0; i < intervals; i++) {
+      for (int k = 1; k < kChecks; k++) {
+        float t = ((float)i + (float)k / kChecks) / intervals;
+        error = std::max(error, std::abs((*this)(t) - ease(curve, t)));
+      }
+    }
+    return error;
+  }
+
+  std::vector<float> samples_;
+  float scale_ = 1.0f;
+  float error_ = 0.0f;
+};
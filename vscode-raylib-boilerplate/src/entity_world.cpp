@@ -0,0 +1,211 @@
+#include "entity_world.h"
+#include <algorithm>
+#include <cmath>
+
+EntityWorld::EntityWorld(Vector2 bounds, Vector2 size)
+    : bounds_(bounds), size_(size),
+      // At least a pixel, entities without size (e.g. from a texture that
+      // failed to load) must not divide by zero
+      cellSize_(std::max({size.x, size.y, 1.0f})) {
+  // Entities are kept inside the bounds, positions are their top left
+  // corners, so one extra column and row covers the right and bottom edge.
+  // At least three columns, so that the right and below left neighbours of
+  // a cell are never the same.
+  columns_ = std::max((uint32_t)std::ceil(bounds.x / cellSize_) + 1, 3u);
+  rows_ = (uint32_t)std::ceil(bounds.y / cellSize_) + 1;
+  cellStart_.resize((size_t)columns_ * rows_ + 1);
+}
+
+uint32_t EntityWorld::spawn(Vector2 position, Vector2 velocity) {
+  x_.push_back(position.x);
+  y_.push_back(position.y);
+  vx_.push_back(velocity.x);
+  vy_.push_back(velocity.y);
+  previousX_.push_back(position.x);
+  previousY_.push_back(position.y);
+  bounce_.push_back(0.0f);
+  ids_.push_back((uint32_t)ids_.size());
+  return ids_.back();
+}
+
+std::span<const Contact> EntityWorld::step(float dt) {
+  contacts_.clear();
+  previousX_.assign(x_.begin(), x_.end());
+  previousY_.assign(y_.begin(), y_.end());
+
+  integrate(dt);
+  collideEdges();
+  buildGrid();
+  collideEntities();
+  decayBounce(dt);
+
+  return contacts_;
+}
+
+void EntityWorld::snapshot(EntityWorldSnapshot &out) const {
+  out.previousX.assign(previousX_.begin(), previousX_.end());
+  out.previousY.assign(previousY_.begin(), previousY_.end());
+  out.x.assign(x_.begin(), x_.end());
+  out.y.assign(y_.begin(), y_.end());
+  out.bounce.assign(bounce_.begin(), bounce_.end());
+}
+
+template <typename T>
+void EntityWorld::permute(std::vector<T> &values, std::vector<T> &scratch) {
+  scratch.resize(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    scratch[i] = values[order_[i]];
+  }
+  values.swap(scratch);
+}
+
+// Branch free over restrict pointers, so the compiler vectorizes it.
+void EntityWorld::integrate(float dt) {
+  float *__restrict x = x_.data();
+  float *__restrict y = y_.data();
+  const float *__restrict vx = vx_.data();
+  const float *__restrict vy = vy_.data();
+  size_t n = x_.size();
+  for (size_t i = 0; i < n; i++) {
+    x[i] += vx[i] * dt;
+    y[i] += vy[i] * dt;
+  }
+}
+
+// Reflects entities off the screen edges. Positions are clamped, so a large
+// step cannot leave an entity outside and flip its velocity back and forth.
+void EntityWorld::collideEdges() {
+  float maxX = bounds_.x - size_.x;
+  float maxY = bounds_.y - size_.y;
+  for (uint32_t i = 0; i < (uint32_t)x_.size(); i++) {
+    if (x_[i] <= 0 || x_[i] >= maxX) {
+      bool left = x_[i] <= 0;
+      x_[i] = left ? 0.0f : maxX;
+      vx_[i] = left ? std::fabs(vx_[i]) : -std::fabs(vx_[i]);
+      bounce_[i] = 1.0f;
+      contacts_.push_back({{left ? 0.0f : bounds_.x, y_[i] + size_.y / 2.0f},
+                           ids_[i],
+                           Contact::kEdge});
+    }
+    if (y_[i] <= 0 || y_[i] >= maxY) {
+      bool top = y_[i] <= 0;
+      y_[i] = top ? 0.0f : maxY;
+      vy_[i] = top ? std::fabs(vy_[i]) : -std::fabs(vy_[i]);
+      bounce_[i] = 1.0f;
+      contacts_.push_back({{x_[i] + size_.x / 2.0f, top ? 0.0f : bounds_.y},
+                           ids_[i],
+                           Contact::kEdge});
+    }
+  }
+}
+
+// Sorts the entities by cell with a counting sort and reorders all entity
+// data accordingly, so the entities of a cell are adjacent in memory. The
+// order changes little from step to step.
+void EntityWorld::buildGrid() {
+  size_t n = x_.size();
+  entityCell_.resize(n);
+  order_.resize(n);
+  std::fill(cellStart_.begin(), cellStart_.end(), 0);
+
+  float inverse = 1.0f / cellSize_;
+  for (size_t i = 0; i < n; i++) {
+    uint32_t column = std::min((uint32_t)(x_[i] * inverse), columns_ - 1);
+    uint32_t row = std::min((uint32_t)(y_[i] * inverse), rows_ - 1);
+    uint32_t cell = row * columns_ + column;
+    entityCell_[i] = cell;
+    cellStart_[cell + 1]++;
+  }
+  for (size_t c = 1; c < cellStart_.size(); c++) {
+    cellStart_[c] += cellStart_[c - 1];
+  }
+  // Fill back to front with the end offsets, which leaves every offset at
+  // the start of its cell.
+  for (size_t c = 0; c + 1 < cellStart_.size(); c++) {
+    cellStart_[c] = cellStart_[c + 1];
+  }
+  for (size_t i = n; i-- > 0;) {
+    order_[--cellStart_[entityCell_[i]]] = (uint32_t)i;
+  }
+
+  permute(x_, floatScratch_);
+  permute(y_, floatScratch_);
+  permute(vx_, floatScratch_);
+  permute(vy_, floatScratch_);
+  permute(previousX_, floatScratch_);
+  permute(previousY_, floatScratch_);
+  permute(bounce_, floatScratch_);
+  permute(ids_, idScratch_);
+  permute(entityCell_, idScratch_);
+}
+
+// Tests every pair of entities in neighbouring cells once. For the entities
+// of a cell these are the later entities of the same cell and the right
+// neighbour, and the entities of the three cells below. Both are contiguous
+// ranges of the sorted entities, which keeps the loops short and branch
+// light. Ranges that wrap around a row end only contain far away entities.
+void EntityWorld::collideEntities() {
+  const uint32_t *start = cellStart_.data();
+  uint32_t cells = columns_ * rows_;
+  uint32_t n = (uint32_t)x_.size();
+  for (uint32_t first = 0; first < n;) {
+    uint32_t cell = entityCell_[first];
+    uint32_t end = start[cell + 1];
+    uint32_t sideEnd = start[std::min(cell + 2, cells)];
+    uint32_t belowBegin = start[std::min(cell + columns_ - 1, cells)];
+    uint32_t belowEnd = start[std::min(cell + columns_ + 2, cells)];
+    for (uint32_t a = first; a < end; a++) {
+      for (uint32_t b = a + 1; b < sideEnd; b++) {
+        collidePair(a, b);
+      }
+      for (uint32_t b = belowBegin; b < belowEnd; b++) {
+        collidePair(a, b);
+      }
+    }
+    first = end;
+  }
+}
+
+// Separates two overlapping entities along the axis of least penetration
+// and exchanges their velocities on that axis, an elastic collision of
+// equal masses.
+void EntityWorld::collidePair(uint32_t i, uint32_t j) {
+  float dx = x_[j] - x_[i];
+  float dy = y_[j] - y_[i];
+  float overlapX = size_.x - std::fabs(dx);
+  float overlapY = size_.y - std::fabs(dy);
+  if (overlapX <= 0 || overlapY <= 0) {
+    return;
+  }
+
+  if (overlapX < overlapY) {
+    float push = std::copysign(overlapX / 2.0f, dx);
+    x_[i] -= push;
+    x_[j] += push;
+    if ((vx_[j] - vx_[i]) * dx < 0) { // Only if they approach.
+      std::swap(vx_[i], vx_[j]);
+    }
+  } else {
+    float push = std::copysign(overlapY / 2.0f, dy);
+    y_[i] -= push;
+    y_[j] += push;
+    if ((vy_[j] - vy_[i]) * dy < 0) {
+      std::swap(vy_[i], vy_[j]);
+    }
+  }
+
+  bounce_[i] = 1.0f;
+  bounce_[j] = 1.0f;
+  contacts_.push_back({{(x_[i] + x_[j]) / 2.0f + size_.x / 2.0f,
+                        (y_[i] + y_[j]) / 2.0f + size_.y / 2.0f},
+                       ids_[i],
+                       ids_[j]});
+}
+
+void EntityWorld::decayBounce(float dt) {
+  float *__restrict bounce = bounce_.data();
+  size_t n = bounce_.size();
+  for (size_t i = 0; i < n; i++) {
+    bounce[i] = std::max(bounce[i] - dt * 1.2f, 0.0f); // Decay rate
+  }
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "raylib.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Contact is reported for every collision of a step, either of an entity
+// with a screen edge or of two entities. a and b are the ids returned by
+// EntityWorld::spawn.
+struct Contact {
+  Vector2 position;
+  uint32_t a;
+  uint32_t b; // kEdge for edge hits.
+
+  static constexpr uint32_t kEdge = UINT32_MAX;
+};
+
+// EntityWorldView is the state rendering needs: the positions before and
+// after the latest step, to interpolate in between, and the bounce values.
+struct EntityWorldView {
+  std::span<const float> previousX;
+  std::span<const float> previousY;
+  std::span<const float> x;
+  std::span<const float> y;
+  std::span<const float> bounce;
+};
+
+// EntityWorldSnapshot is a copy of an EntityWorldView that can be handed to
+// another thread. Copying into the same snapshot again does not allocate.
+struct EntityWorldSnapshot {
+  std::vector<float> previousX;
+  std::vector<float> previousY;
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> bounce;
+
+  EntityWorldView view() const { return {previousX, previousY, x, y, bounce}; }
+};
+
+// EntityWorld simulates many equally sized sprites bouncing off the screen
+// edges and off each other. Entity data is stored as structure of arrays, so
+// integration runs in vectorizable loops, and collisions are found through a
+// uniform grid with one sprite sized cell per bucket, so each entity is only
+// tested against the entities in its own and the neighbouring cells.
+// Every step sorts the entity data by cell, so the arrays of a view are in
+// a different order after each step, but always consistent with each other.
+class EntityWorld {
+public:
+  // bounds is the screen size, size the size of every sprite.
+  EntityWorld(Vector2 bounds, Vector2 size);
+
+  // Adds an entity with its top left corner at position, velocity in pixels
+  // per second. Returns its id.
+  uint32_t spawn(Vector2 position, Vector2 velocity);
+
+  // Advances all entities by dt seconds. The returned contacts stay valid
+  // until the next call.
+  std::span<const Contact> step(float dt);
+
+  size_t size() const { return x_.size(); }
+  Vector2 spriteSize() const { return size_; }
+  EntityWorldView view() const {
+    return {previousX_, previousY_, x_, y_, bounce_};
+  }
+  void snapshot(EntityWorldSnapshot &out) const;
+
+private:
+  void integrate(float dt);
+  void collideEdges();
+  void buildGrid();
+  void collideEntities();
+  void collidePair(uint32_t i, uint32_t j);
+  void decayBounce(float dt);
+  template <typename T>
+  void permute(std::vector<T> &values, std::vector<T> &scratch);
+
+  Vector2 bounds_;
+  Vector2 size_;
+
+  // Entity data
+  std::vector<float> x_;
+  std::vector<float> y_;
+  std::vector<float> vx_;
+  std::vector<float> vy_;
+  std::vector<float> previousX_;
+  std::vector<float> previousY_;
+  std::vector<float> bounce_; // 1.0f right after a collision, decays to 0.0f.
+  std::vector<uint32_t> ids_;
+
+  // Uniform grid, entities sorted by cell: the entities of cell c are
+  // [cellStart_[c], cellStart_[c + 1]).
+  float cellSize_;
+  uint32_t columns_;
+  uint32_t rows_;
+  std::vector<uint32_t> cellStart_;
+  std::vector<uint32_t> entityCell_; // Cell of each entity, sorted.
+  std::vector<uint32_t> order_; // Previous index of each sorted entity.
+  std::vector<float> floatScratch_;
+  std::vector<uint32_t> idScratch_;
+
+  std::vector<Contact> contacts_;
+};
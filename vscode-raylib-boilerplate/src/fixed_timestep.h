@@ -0,0 +1,144 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+// Building blocks for running a simulation at a fixed rate, independent of
+// the render rate: a step accumulator for the render thread, a lock-free
+// snapshot buffer and event queue, and a thread that steps on its own.
+
+using SimClock = std::chrono::steady_clock;
+
+// FixedTimestep turns variable frame times into a whole number of fixed
+// simulation steps. What is left over stays in the accumulator and is
+// exposed as alpha(), the fraction of a step to interpolate rendering by.
+class FixedTimestep {
+public:
+  explicit FixedTimestep(float step, float maxFrameTime = 0.25f)
+      : step_(step), maxFrameTime_(maxFrameTime) {}
+
+  // Adds frameTime and returns how many steps to simulate now. Frame times
+  // above maxFrameTime are clamped, so after a hitch the simulation slows
+  // down briefly instead of catching up with a burst of steps.
+  int advance(float frameTime) {
+    accumulator_ += std::clamp(frameTime, 0.0f, maxFrameTime_);
+    int steps = 0;
+    while (accumulator_ >= step_) {
+      accumulator_ -= step_;
+      steps++;
+    }
+    return steps;
+  }
+
+  float step() const { return step_; }
+  float alpha() const { return (float)(accumulator_ / step_); }
+
+private:
+  float step_;
+  float maxFrameTime_;
+  double accumulator_ = 0.0;
+};
+
+// TripleBuffer hands snapshots from one writer thread to one reader thread
+// without locks or waiting. The writer fills back() and publishes it, the
+// reader picks up the latest published snapshot with update() and reads it
+// through front(). Snapshots published in between are skipped.
+template <typename T> class TripleBuffer {
+public:
+  T &back() { return slots_[back_]; }
+  const T &front() const { return slots_[front_]; }
+
+  // Makes back() the latest snapshot and hands the writer a free slot.
+  void publish() {
+    back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) &
+            kIndex;
+  }
+
+  // Moves the latest snapshot to front(). Returns false if nothing new was
+  // published since the last call.
+  bool update() {
+    if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0) {
+      return false;
+    }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+    return true;
+  }
+
+private:
+  static constexpr uint8_t kIndex = 3;
+  static constexpr uint8_t kFresh = 4;
+
+  std::array<T, 3> slots_{};
+  uint8_t back_ = 0;
+  std::atomic<uint8_t> middle_{1};
+  uint8_t front_ = 2;
+};
+
+// SpscQueue is a bounded lock-free queue for one producer and one consumer
+// thread. Capacity must be a power of two.
+template <typename T, size_t Capacity> class SpscQueue {
+  static_assert((Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of two");
+
+public:
+  // Returns false if the queue is full and value was dropped.
+  bool push(const T &value) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+      return false;
+    }
+    items_[tail & (Capacity - 1)] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  std::optional<T> pop() {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return std::nullopt;
+    }
+    T value = items_[head & (Capacity - 1)];
+    head_.store(head + 1, std::memory_order_release);
+    return value;
+  }
+
+private:
+  std::array<T, Capacity> items_{};
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+};
+
+// SimulationThread calls step() every stepSeconds on its own thread until
+// it is destroyed. When it falls behind by more than maxLag it skips ahead
+// instead of running a burst of steps.
+class SimulationThread {
+public:
+  template <typename Step>
+  SimulationThread(float stepSeconds, Step step,
+                   std::chrono::milliseconds maxLag =
+                       std::chrono::milliseconds(250))
+      : thread_([=](std::stop_token stop) mutable {
+          auto period = std::chrono::duration_cast<SimClock::duration>(
+              std::chrono::duration<float>(stepSeconds));
+          auto next = SimClock::now();
+          while (!stop.stop_requested()) {
+            step();
+            next += period;
+            auto now = SimClock::now();
+            if (now - next > maxLag) {
+              next = now;
+            }
+            std::this_thread::sleep_until(next);
+          }
+        }) {}
+
+private:
+  std::jthread thread_;
+};
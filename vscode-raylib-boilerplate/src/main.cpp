@@ -1,41 +1,414 @@
 #include "raylib.h"
-#include "../vendor/reasings.h"
-#include "partikel_wrapper.h"
+#include "asset_manager.h"
+#include "easing.h"
+#include "entity_world.h"
+#include "fixed_timestep.h"
+#include "particle_budget.h"
+#include "policy_emitter.h"
+#include "profiler.h"
+#include "replay.h"
+#include "sound_pool.h"
+#include "sprite_batch.h"
+#include "texture_atlas.h"
+#include "tween.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
 #include <print>
+#include <random>
+#include <string_view>
+#include <thread>
+#include <vector>
 
-int main() {
+// Simulation rate, independent of the render rate.
+constexpr float kSimulationHz = 120.0f;
+
+constexpr int kScreenWidth = 800;
+constexpr int kScreenHeight = 600;
+
+// WorldSnapshot is what the simulation thread hands to the renderer. time
+// is when the latest step was simulated.
+struct WorldSnapshot {
+  EntityWorldSnapshot world;
+  SimClock::time_point time;
+};
+
+// BounceEvent is sent from the simulation to the main thread, which plays
+// the sound and bursts the particles. Contacts beyond the queue capacity
+// are dropped, which bounds the effects per frame.
+struct BounceEvent {
+  Vector2 position;
+};
+
+using BounceEvents = SpscQueue<BounceEvent, 256>;
+
+// stepWorld advances the world by dt seconds and reports its contacts.
+static void stepWorld(EntityWorld &world, float dt, BounceEvents &events) {
+  PROFILE_ZONE("simulate");
+  for (const Contact &contact : world.step(dt)) {
+    if (!events.push({contact.position})) {
+      break;
+    }
+  }
+}
+
+// The burst of a bounce or a click, falling with gravity and swirled by the
+// force field. Equal seeds give equal particles.
+using Sparks = PolicyEmitter<AgeDeactivator, ConstantAcceleration, FieldForce>;
+constexpr ConstantAcceleration kSparkGravity{{0.0f, 50.0f}};
+
+// Sparks near the pointer are swirled around it by a vortex of the force
+// field, whose grid covers the screen in kSparkFieldCell pixel cells.
+constexpr float kSparkFieldCell = 32.0f;
+constexpr float kPointerVortexStrength = 400.0f;
+constexpr float kPointerVortexRadius = 120.0f;
+
+// Sparks cool from white over yellow to a fading red and shrink.
+constexpr ColorStop kSparkColors[] = {{0.0f, {255, 255, 255, 255}},
+                                      {0.25f, {255, 220, 120, 255}},
+                                      {0.6f, {255, 120, 40, 200}},
+                                      {1.0f, {200, 40, 20, 0}}};
+constexpr FloatStop kSparkScale[] = {{0.0f, 1.5f}, {1.0f, 0.5f}};
+
+// Bounce storms of many kets are capped by a particle budget, which also
+// thins the bursts while frames take longer than kSparkFrameTime.
+constexpr size_t kSparkCapacity = 2048;
+constexpr size_t kMaxSparks = 1500;
+constexpr float kSparkFrameTime = 1.0f / 45.0f;
+
+static ParticleConfig burstConfig(const ParticleSprite &sprite, uint64_t seed) {
+  return ParticleConfig()
+      .direction({1.0f, 0.0f}, 0.0f, 360.0f)
+      .velocity(50.0f, 150.0f)
+      .velocityAngle(-10.0f, 10.0f)
+      .offset(0.0f, 10.0f)
+      .burst(10, 20)
+      .capacity(kSparkCapacity)
+      .age(0.5f, 1.5f)
+      .colors(kSparkColors)
+      .scale(kSparkScale)
+      .blend(BLEND_ADDITIVE)
+      .sprite(sprite)
+      .seed(seed);
+}
+
+// Game is the state the main loop advances every frame. It needs neither
+// a window nor an audio device, so it also runs headless.
+struct Game {
+  Game(Vector2 ketSize, int ketCount, uint64_t seed,
+       const ParticleSprite &particleSprite)
+      : world({(float)kScreenWidth, (float)kScreenHeight}, ketSize),
+        particles(burstConfig(particleSprite, seed), kSparkGravity,
+                  FieldForce{sparkField.get()}) {
+    if (ketCount == 1) {
+      world.spawn({250.0f, 50.0f}, {180.0f, 120.0f});
+    } else {
+      std::mt19937 random((uint32_t)seed);
+      std::uniform_real_distribution<float> x(0.0f, kScreenWidth - ketSize.x);
+      std::uniform_real_distribution<float> y(0.0f,
+                                              kScreenHeight - ketSize.y);
+      std::uniform_real_distribution<float> speed(-200.0f, 200.0f);
+      for (int i = 0; i < ketCount; i++) {
+        world.spawn({x(random), y(random)}, {speed(random), speed(random)});
+      }
+    }
+
+    // The kets fade in after loading, the profiler hint fades in and out
+    tweens.add(&ketAlpha, 0.0f, 1.0f, 0.6f, Ease::QuadOut);
+    TweenId hint =
+        tweens.add(&hintAlpha, 0.0f, 1.0f, 0.4f, Ease::SineOut, 0.6f);
+    tweens.then(hint, &hintAlpha, 1.0f, 0.0f, 0.8f, Ease::SineIn, 2.5f);
+
+    particleBudget.add(particles.get());
+    sparkField.vortex({}, kPointerVortexStrength, kPointerVortexRadius);
+  }
+
+  Game(const Game &) = delete;
+  Game &operator=(const Game &) = delete;
+
+  EntityWorld world;
+  FixedTimestep timestep{1.0f / kSimulationHz};
+  BounceEvents bounceEvents;
+  ParticleForceField sparkField{
+      {0.0f, 0.0f, (float)kScreenWidth, (float)kScreenHeight},
+      kSparkFieldCell};
+  Sparks particles;
+  ParticleBudget particleBudget{kMaxSparks, kSparkFrameTime};
+  TweenScheduler tweens;
+  float ketAlpha = 0.0f;
+  float hintAlpha = 0.0f;
+  bool showProfiler = false; // F3 shows where the milliseconds go.
+};
+
+// A single ket keeps its texture size, many kets are scaled down
+static Vector2 ketSizeFor(const Image &image, int ketCount) {
+  Vector2 size = {(float)image.width, (float)image.height};
+  if (ketCount > 1) {
+    float scale = 16.0f / std::max(size.x, size.y);
+    size = {size.x * scale, size.y * scale};
+  }
+  return size;
+}
+
+// updateGame runs the logic of one frame. Everything it reads from the user
+// comes in through input, so replaying the inputs of a run replays the run.
+// With simulate false the world is stepped by the simulation thread.
+// Returns how many bounces to play a sound for.
+static int updateGame(Game &game, const FrameInput &input, bool simulate) {
+  if (input.buttons & kInputToggleProfiler) {
+    game.showProfiler = !game.showProfiler;
+  }
+  if (simulate) {
+    for (int steps = game.timestep.advance(input.frameTime); steps > 0;
+         steps--) {
+      stepWorld(game.world, game.timestep.step(), game.bounceEvents);
+    }
+  }
+
+  // Create particle bursts at collision points and clicks, as many as the
+  // budget allows. The frame time is the recorded one, so replays degrade
+  // the same way.
+  game.particleBudget.update(input.frameTime);
+  int bounces = 0;
+  while (auto event = game.bounceEvents.pop()) {
+    game.particles.burst(event->position);
+    bounces++;
+  }
+  if (input.buttons & kInputBurst) {
+    game.particles.burst(input.pointer);
+    bounces++;
+  }
+
+  game.sparkField.forces()[0].position = input.pointer;
+  game.sparkField.rasterize();
+  game.particles.update(input.frameTime);
+  game.tweens.update(input.frameTime);
+  return bounces;
+}
+
+// Hashes the simulated state, to compare a replay with its recording.
+static uint64_t checksum(const Game &game) {
+  EntityWorldView view = game.world.view();
+  ParticleView particles = game.particles.particles();
+  uint64_t hash = hashFloats(view.x);
+  hash = hashFloats(view.y, hash);
+  hash = hashFloats(view.bounce, hash);
+  hash = hashFloats(particles.x, hash);
+  return hashFloats(particles.y, hash);
+}
+
+// Command line options, see the start of main
+struct Options {
+  bool simThread = false;
+  int targetFps = 60;
+  int ketCount = 1;
+  uint64_t seed = 42;
+  int headlessTicks = 0;
+  const char *tracePath = nullptr;
+  const char *recordPath = nullptr;
+  const char *replayPath = nullptr;
+};
+
+// runHeadless runs the game without a window and audio device, either for
+// options.headlessTicks frames of one simulation step each or for the
+// frames of a replay, whose checksums it verifies. It prints how many ticks
+// per second were simulated. Returns the exit code.
+static int runHeadless(const Options &options) {
+  SetTraceLogLevel(LOG_WARNING); // Keep the output to the results.
+  Replay replay;
+  bool replaying = options.replayPath != nullptr;
+  if (replaying) {
+    if (!replay.load(options.replayPath)) {
+      return EXIT_FAILURE;
+    }
+    if (replay.header.simulationHz != kSimulationHz ||
+        replay.header.bounds.x != kScreenWidth ||
+        replay.header.bounds.y != kScreenHeight) {
+      std::println("{} was recorded with a different simulation setup",
+                   options.replayPath);
+      return EXIT_FAILURE;
+    }
+  } else {
+    // The image is only decoded for its size, nothing is uploaded
+    AssetManager assets;
+    const char *appDir = GetApplicationDirectory();
+    assets.mount(TextFormat("%s/assets.pak", appDir),
+                 TextFormat("%s/assets", appDir));
+    ImageHandle ketHandle =
+        assets.loadImage(TextFormat("%s/assets/ket.png", appDir));
+    while (!assets.idle()) {
+      assets.update();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!assets.ready(ketHandle)) {
+      std::println("Cannot load the ket image, which sets the world scale");
+      return EXIT_FAILURE;
+    }
+    replay.header = {.seed = options.seed,
+                     .simulationHz = kSimulationHz,
+                     .ketCount = options.ketCount,
+                     .bounds = {(float)kScreenWidth, (float)kScreenHeight},
+                     .ketSize = ketSizeFor(assets.image(ketHandle),
+                                           options.ketCount)};
+  }
+
+  // The particle source matches the atlas region of the windowed run
+  Game game(replay.header.ketSize, replay.header.ketCount, replay.header.seed,
+            ParticleSprite{{}, {0.0f, 0.0f, 4.0f, 4.0f}});
+  bool recording = options.recordPath != nullptr;
+  bool verifying = replaying || recording;
+  size_t ticks = replaying ? replay.frames.size()
+                           : (size_t)std::max(options.headlessTicks, 0);
+  FrameInput fixed = {.frameTime = game.timestep.step()};
+  if (options.tracePath) {
+    Profiler::startTrace();
+  }
+
+  bool diverged = false;
+  size_t tick = 0;
+  auto start = SimClock::now();
+  for (; tick < ticks && !diverged; tick++) {
+    const FrameInput &input = replaying ? replay.frames[tick].input : fixed;
+    updateGame(game, input, true);
+    if (options.tracePath) {
+      Profiler::endFrame();
+    }
+    if (!verifying) {
+      continue;
+    }
+    uint64_t sum = checksum(game);
+    diverged = replaying && sum != replay.frames[tick].checksum;
+    if (recording && !replaying) {
+      replay.frames.push_back({input, sum});
+    }
+  }
+  double seconds =
+      std::chrono::duration<double>(SimClock::now() - start).count();
+
+  std::println("{} ticks, {} kets: {:.3f} s, {:.0f} ticks/s, checksum {:016x}",
+               tick, game.world.size(), seconds,
+               seconds > 0.0 ? tick / seconds : 0.0, checksum(game));
+  if (options.tracePath) {
+    Profiler::writeTrace(options.tracePath);
+  }
+  if (diverged) {
+    std::println("Replay diverged at frame {}", tick - 1);
+    return EXIT_FAILURE;
+  }
+  if (recording && !replaying && !replay.save(options.recordPath)) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv) {
   TraceLog(LOG_INFO, "Starting raylib with C++23!");
 
+  // --sim-thread runs the simulation on its own thread, --fps N sets the
+  // render rate (0 = unlimited), --kets N bounces N kets off each other,
+  // --seed N seeds the kets and particles, --trace FILE writes the profiler
+  // zones of the run as a Chrome trace, --record FILE records the inputs of
+  // the run, --headless N runs N ticks without a window, --replay FILE
+  // replays a recorded run without a window and checks it matches
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg = argv[i];
+    if (arg == "--sim-thread") {
+      options.simThread = true;
+    } else if (arg == "--fps" && i + 1 < argc) {
+      options.targetFps = std::atoi(argv[++i]);
+    } else if (arg == "--kets" && i + 1 < argc) {
+      options.ketCount = std::max(std::atoi(argv[++i]), 1);
+    } else if (arg == "--seed" && i + 1 < argc) {
+      // Emitters take a seed of 0 as a request for a random one
+      options.seed = std::max(std::strtoull(argv[++i], nullptr, 10), 1ull);
+    } else if (arg == "--trace" && i + 1 < argc) {
+      options.tracePath = argv[++i];
+    } else if (arg == "--record" && i + 1 < argc) {
+      options.recordPath = argv[++i];
+    } else if (arg == "--headless" && i + 1 < argc) {
+      options.headlessTicks = std::atoi(argv[++i]);
+    } else if (arg == "--replay" && i + 1 < argc) {
+      options.replayPath = argv[++i];
+    }
+  }
+  if (options.headlessTicks > 0 || options.replayPath) {
+    return runHeadless(options);
+  }
+  if (options.recordPath && options.simThread) {
+    // The thread steps at wall clock times, which a replay cannot repeat
+    TraceLog(LOG_WARNING, "--record simulates on the main thread");
+    options.simThread = false;
+  }
+
   // Let raylib handle resource paths automatically
   const char *appDir = GetApplicationDirectory();
   TraceLog(LOG_INFO, "Application directory: %s", appDir);
   TraceLog(LOG_INFO, "Current working directory: %s", GetWorkingDirectory());
 
   // Initialize window and audio
-  const int screenWidth = 800;
-  const int screenHeight = 600;
-  InitWindow(screenWidth, screenHeight, "raylib + C++23 - Bouncing Ket");
+  InitWindow(kScreenWidth, kScreenHeight, "raylib + C++23 - Bouncing Ket");
   InitAudioDevice();
 
-  SetTargetFPS(60);
+  SetTargetFPS(options.targetFps);
+
+  // Decode in the background, decoded data is cached across runs
+  AssetManager assets(std::filesystem::temp_directory_path() /
+                      "raylib-app-asset-cache");
+  // Prefer the packed archive next to the binary over the loose files
+  assets.mount(TextFormat("%s/assets.pak", appDir),
+               TextFormat("%s/assets", appDir));
 
   // Load assets relative to the binary location
   const char *texturePath =
       TextFormat("%s/assets/ket.png", GetApplicationDirectory());
   const char *soundPath =
       TextFormat("%s/assets/bounce.wav", GetApplicationDirectory());
-
   TraceLog(LOG_INFO, "Attempting to load texture from: %s", texturePath);
-  Texture2D ketTexture = LoadTexture(texturePath);
-  TraceLog(LOG_INFO, "Texture loaded - ID: %u, Width: %d, Height: %d",
-           ketTexture.id, ketTexture.width, ketTexture.height);
+  ImageHandle ketHandle = assets.loadImage(texturePath);
+  TraceLog(LOG_INFO, "Attempting to load sound from: %s", soundPath);
+  SoundHandle bounceHandle = assets.loadSound(soundPath);
+
+  // The simulation needs the texture size, show a loading screen until then
+  while (!assets.idle() && !WindowShouldClose()) {
+    assets.update();
+    BeginDrawing();
+    ClearBackground(BLACK);
+    DrawText("Loading...", 20, 20, 20, RAYWHITE);
+    EndDrawing();
+  }
+  if (!assets.idle()) {
+    // Closed while loading, workers may still write the assets
+    assets.unloadAll();
+    CloseAudioDevice();
+    CloseWindow();
+    return 0;
+  }
+  if (!assets.ready(ketHandle)) {
+    TraceLog(LOG_ERROR, "Cannot load the ket image, which sets the world scale");
+    assets.unloadAll();
+    CloseAudioDevice();
+    CloseWindow();
+    return EXIT_FAILURE;
+  }
 
-  // Define fixed rectangle dimensions based on texture
-  float rectWidth = (float)ketTexture.width;
-  float rectHeight = (float)ketTexture.height;
+  const Image &ketImage = assets.image(ketHandle);
+  TraceLog(LOG_INFO, "Image loaded - Width: %d, Height: %d", ketImage.width,
+           ketImage.height);
 
-  TraceLog(LOG_INFO, "Attempting to load sound from: %s", soundPath);
-  Sound bounceSound = LoadSound(soundPath);
+  // Kets and particles share an atlas page, so drawing them together does
+  // not switch textures
+  TextureAtlas atlas;
+  uint32_t ketRegion = atlas.add(ketImage);
+  Image particleImage = GenImageColor(4, 4, WHITE);
+  uint32_t particleRegion = atlas.add(particleImage);
+  UnloadImage(particleImage);
+  atlas.build();
+  SpriteBatch sprites(atlas);
+
+  Sound bounceSound = assets.sound(bounceHandle);
   bool soundLoaded = (bounceSound.frameCount > 0);
 
   TraceLog(LOG_INFO, "Sound frameCount: %u", bounceSound.frameCount);
@@ -47,99 +420,150 @@ int main() {
     TraceLog(LOG_INFO, "Bounce sound loaded successfully!");
   }
 
-  // Movement velocity
-  float dx = 3.0f;
-  float dy = 2.0f;
+  // Bounces play through a few pooled voices, at most once per frame
+  SoundPool sounds;
+  int bounceSample = soundLoaded ? sounds.add(bounceSound, 4) : -1;
+
+  Vector2 ketSize = ketSizeFor(ketImage, options.ketCount);
+  Vector2 imageCenterOffset = {ketSize.x / 2.0f, ketSize.y / 2.0f};
+  const AtlasRegion &spark = atlas.region(particleRegion);
+  ParticleTextures particleTextures;
+  particleTextures.add("spark", atlas.page(spark.page), spark.source);
+  Game game(ketSize, options.ketCount, options.seed,
+            *particleTextures.find("spark"));
 
-  // Bounce value (1.0f → 0.0f)
-  float bounce = 0.0f;
+  // What a replay needs to repeat this run
+  Replay replay;
+  replay.header = {.seed = options.seed,
+                   .simulationHz = kSimulationHz,
+                   .ketCount = options.ketCount,
+                   .bounds = {(float)kScreenWidth, (float)kScreenHeight},
+                   .ketSize = ketSize};
 
-  Rectangle imageRect = {250.0f, 50.0f, rectWidth, rectHeight};
-  Vector2 imageCenterOffset = {(float)ketTexture.width / 2.0f,
-                               (float)ketTexture.height / 2.0f};
-  Rectangle imageSourceRect = {0, 0, (float)ketTexture.width,
-                               (float)ketTexture.height};
+  // Simulation, either stepped by updateGame or on its own thread
+  TripleBuffer<WorldSnapshot> snapshots;
+  std::unique_ptr<SimulationThread> simulation;
+  if (options.simThread) {
+    game.world.snapshot(snapshots.back().world);
+    snapshots.back().time = SimClock::now();
+    snapshots.publish();
+    snapshots.update();
+    float step = game.timestep.step();
+    simulation = std::make_unique<SimulationThread>(step, [&game, &snapshots,
+                                                           step] {
+      stepWorld(game.world, step, game.bounceEvents);
+      WorldSnapshot &snapshot = snapshots.back();
+      game.world.snapshot(snapshot.world);
+      snapshot.time = SimClock::now();
+      snapshots.publish();
+    });
+  }
 
-  // Simple particle system
-  SimpleParticleSystem particles;
+  // Progress of the bounce animation per entity, eased in one batch
+  std::vector<float> easedBounce;
+
+  if (options.tracePath) {
+    Profiler::startTrace();
+  }
 
   // Main game loop
   while (!WindowShouldClose()) {
-    // Update collision rectangle position
-    imageRect.x += dx;
-    imageRect.y += dy;
-
-    // Bounce off edges with sound and particles
-    if (imageRect.x <= 0 || imageRect.x >= screenWidth - imageRect.width) {
-      dx = -dx;
-      if (soundLoaded) {
-        TraceLog(LOG_DEBUG, "Playing bounce sound (horizontal)");
-        PlaySound(bounceSound);
-      }
-      // Create particle burst at collision point
-      Vector2 burstPos = {imageRect.x <= 0 ? 0.0f : (float)screenWidth,
-                          imageRect.y + imageRect.height / 2.0f};
-      particles.burst(burstPos);
-
-      // Trigger bounce
-      bounce = 1.0f;
-    }
-    if (imageRect.y <= 0 || imageRect.y >= screenHeight - imageRect.height) {
-      dy = -dy;
-      if (soundLoaded) {
-        TraceLog(LOG_DEBUG, "Playing bounce sound (vertical)");
-        PlaySound(bounceSound);
-      }
-      // Create particle burst at collision point
-      Vector2 burstPos = {imageRect.x + imageRect.width / 2.0f,
-                          imageRect.y <= 0 ? 0.0f : (float)screenHeight};
-      particles.burst(burstPos);
+    FrameInput input = {.frameTime = GetFrameTime(),
+                        .pointer = GetMousePosition()};
+    if (IsKeyPressed(KEY_F3)) {
+      input.buttons |= kInputToggleProfiler;
+    }
+    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+      input.buttons |= kInputBurst;
+    }
 
-      // Trigger bounce
-      bounce = 1.0f;
+    EntityWorldView view;
+    float alpha;
+    PROFILE_BEGIN("update");
+    int bounces = updateGame(game, input, !simulation);
+    if (simulation) {
+      snapshots.update();
+      const WorldSnapshot &latest = snapshots.front();
+      view = latest.world.view();
+      alpha = std::chrono::duration<float>(SimClock::now() - latest.time)
+                  .count() /
+              game.timestep.step();
+      alpha = std::clamp(alpha, 0.0f, 1.0f);
+    } else {
+      view = game.world.view();
+      alpha = game.timestep.alpha();
+    }
+    if (options.recordPath) {
+      replay.frames.push_back({input, checksum(game)});
     }
 
-    // Update bounce (decay from 1.0f → 0.0f)
-    float deltaTime = GetFrameTime();
-    if (bounce > 0.0f) {
-      bounce -= deltaTime * 1.2f; // Decay rate
-      if (bounce < 0.0f) {
-        bounce = 0.0f;
+    // Play a sound per bounce, merged by the pool
+    if (soundLoaded) {
+      for (int i = 0; i < bounces; i++) {
+        sounds.trigger(bounceSample);
       }
     }
-
-    // Update particles
-    particles.update(deltaTime);
+    sounds.flush();
+    PROFILE_END();
 
     // Draw
     BeginDrawing();
     ClearBackground(BLACK);
 
-    float easedBounce = EaseElasticOut(1.0f - bounce, 0.0f, 1.0f, 1.0f);
-    float rotation = (1 - easedBounce) * 15.0f; // Rotate based on bounce
+    PROFILE_BEGIN("draw");
+    easedBounce.resize(view.x.size());
+    for (size_t i = 0; i < view.x.size(); i++) {
+      easedBounce[i] = 1.0f - view.bounce[i];
+    }
+    ease<Ease::ElasticOut>(easedBounce, easedBounce);
+    Color ketTint = Fade(WHITE, game.ketAlpha);
+    for (size_t i = 0; i < view.x.size(); i++) {
+      float x = view.previousX[i] + (view.x[i] - view.previousX[i]) * alpha;
+      float y = view.previousY[i] + (view.y[i] - view.previousY[i]) * alpha;
+      float rotation = (1 - easedBounce[i]) * 15.0f; // Rotate based on bounce
+
+      Rectangle destRect = {.x = x + imageCenterOffset.x,
+                            .y = y + imageCenterOffset.y,
+                            .width = ketSize.x,
+                            .height = ketSize.y};
+      sprites.draw(ketRegion, destRect, imageCenterOffset, rotation, ketTint);
+    }
+    sprites.flush();
+    PROFILE_END();
 
-    Rectangle destRect = {.x = imageRect.x + imageCenterOffset.x,
-                          .y = imageRect.y + imageCenterOffset.y,
-                          .width = imageRect.width,
-                          .height = imageRect.height};
-    DrawTexturePro(ketTexture, imageSourceRect, destRect, imageCenterOffset,
-                   rotation, WHITE);
+    // Draw particles, leaving out the ones gravity pulled off the screen
+    game.particles.draw(
+        {0.0f, 0.0f, (float)kScreenWidth, (float)kScreenHeight});
 
-    // Draw particles
-    particles.draw();
+    if (game.showProfiler) {
+      Profiler::drawOverlay(10, 10);
+    } else if (game.hintAlpha > 0.0f) {
+      DrawText("F3: profiler", 10, 10, 10, Fade(RAYWHITE, game.hintAlpha));
+    }
 
-    EndDrawing();
+    {
+      PROFILE_ZONE("EndDrawing");
+      EndDrawing();
+    }
+    Profiler::endFrame();
   }
 
   // Cleanup
-  if (soundLoaded) {
-    UnloadSound(bounceSound);
+  simulation.reset();
+  if (options.tracePath) {
+    Profiler::writeTrace(options.tracePath);
+  }
+  if (options.recordPath) {
+    replay.save(options.recordPath);
   }
-  UnloadTexture(ketTexture);
-  // Particle system cleanup is automatic
+  sounds.clear();
+  assets.unloadAll();
+  particleTextures.unload();
+  atlas.unload();
+  // The particles are freed with the game
   CloseAudioDevice();
   CloseWindow();
 
   TraceLog(LOG_INFO, "raylib window closed!");
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,91 @@
+#include "particle_budget.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+// Weight of the latest frame in the smoothed frame time.
+constexpr float kFrameTimeSmoothing = 0.25f;
+// Level of detail lost per second of frames taking twice the target.
+constexpr float kDropPerSecond = 2.0f;
+// Level of detail regained per second of fast frames.
+constexpr float kRecoveryPerSecond = 0.5f;
+// Frame times above this are clamped, as in FixedTimestep.
+constexpr float kMaxFrameTime = 0.25f;
+// Most level of detail lost in one frame, so a single hitch only dents it.
+constexpr float kMaxDropPerFrame = 0.1f;
+
+void release(Emitter *emitter) {
+  emitter->spawnScale = 1.0f;
+  emitter->spawnBudget = SIZE_MAX;
+  emitter->culled = false;
+}
+
+} // namespace
+
+void ParticleBudget::add(Emitter *emitter, int priority) {
+  auto at = std::find_if(
+      entries_.begin(), entries_.end(),
+      [priority](const Entry &entry) { return entry.priority < priority; });
+  entries_.insert(at, {emitter, priority});
+}
+
+void ParticleBudget::remove(const Emitter *emitter) {
+  auto at = std::find_if(
+      entries_.begin(), entries_.end(),
+      [emitter](const Entry &entry) { return entry.emitter == emitter; });
+  if (at != entries_.end()) {
+    release(at->emitter);
+    entries_.erase(at);
+  }
+}
+
+void ParticleBudget::clear() {
+  for (Entry &entry : entries_) {
+    release(entry.emitter);
+  }
+  entries_.clear();
+}
+
+void ParticleBudget::update(float frameTime) {
+  // A hitch, e.g. the window being dragged, must not throw away all
+  // effects: only sustained slow frames bring the level of detail down.
+  frameTime = std::clamp(frameTime, 0.0f, kMaxFrameTime);
+  frameTime_ += (frameTime - frameTime_) * kFrameTimeSmoothing;
+  float over = frameTime_ / targetFrameTime_ - 1.0f;
+  if (over > 0.0f) {
+    float drop = std::min(kDropPerSecond * over * frameTime, kMaxDropPerFrame);
+    levelOfDetail_ = std::max(levelOfDetail_ - drop, 0.0f);
+  } else {
+    levelOfDetail_ =
+        std::min(levelOfDetail_ + kRecoveryPerSecond * frameTime, 1.0f);
+  }
+
+  live_ = 0;
+  int tiers = 0;
+  for (size_t i = 0; i < entries_.size(); i++) {
+    live_ += entries_[i].emitter->length;
+    if (i == 0 || entries_[i].priority != entries_[i - 1].priority) {
+      tiers++;
+    }
+  }
+
+  cap_ = (size_t)((float)maxParticles_ * levelOfDetail_);
+  size_t left = cap_ > live_ ? cap_ - live_ : 0;
+  int tier = -1;
+  for (size_t i = 0; i < entries_.size(); i++) {
+    if (i == 0 || entries_[i].priority != entries_[i - 1].priority) {
+      tier++;
+    }
+    Emitter *e = entries_[i].emitter;
+    float scale =
+        std::clamp(levelOfDetail_ * (float)tiers - (float)tier, 0.0f, 1.0f);
+    size_t wants =
+        (size_t)((float)(e->config.capacity - e->length) * scale + 0.5f);
+    size_t budget = std::min(wants, left);
+    left -= budget;
+    e->spawnScale = scale;
+    e->spawnBudget = budget;
+    e->culled = scale == 0.0f;
+  }
+}
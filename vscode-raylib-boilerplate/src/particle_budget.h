@@ -0,0 +1,66 @@
+#pragma once
+#include "../vendor/partikel.h"
+#include <cstddef>
+#include <vector>
+
+// ParticleBudget keeps the particles of many emitters under a global cap
+// and thins them out while frames are slow, so a storm of bursts degrades
+// the effects instead of the frame rate.
+//
+// update(), called once per frame before the emitters are burst or
+// updated, keeps a level of detail between 0 and 1. While the smoothed
+// frame time runs over the target it drops, the faster the further over,
+// and it recovers slowly once frames are fast again. A single long frame
+// only takes a small step off. Lower priorities are thinned first:
+// with n distinct priorities the lowest spawns fully only at a level of
+// detail of 1 and nothing below (n - 1) / n, the highest fully down to
+// 1 / n.
+// Emitters thinned to nothing are culled, they keep updating but are not
+// drawn.
+//
+// The cap, scaled by the level of detail, is then handed out as spawn
+// budgets, highest priority first: each emitter gets as much of what is
+// left as it could spawn at its thinning.
+class ParticleBudget {
+public:
+  // targetFrameTime should be above the usual frame time, e.g. 1 / 45 s
+  // for a game running at 60 fps.
+  explicit ParticleBudget(size_t maxParticles,
+                          float targetFrameTime = 1.0f / 45.0f)
+      : maxParticles_(maxParticles), targetFrameTime_(targetFrameTime) {}
+  ~ParticleBudget() { clear(); }
+
+  ParticleBudget(const ParticleBudget &) = delete;
+  ParticleBudget &operator=(const ParticleBudget &) = delete;
+
+  // Adds emitter, e.g. ParticleEmitter::get() or one of a ParticleSystem.
+  // It must be removed before it is freed.
+  void add(Emitter *emitter, int priority = 0);
+
+  // Removes emitter and lets it spawn and draw freely again.
+  void remove(const Emitter *emitter);
+  void clear();
+
+  // Adapts to frameTime and hands out the spawn budgets for this frame. Not
+  // while the emitters are updated on other threads.
+  void update(float frameTime);
+
+  float levelOfDetail() const { return levelOfDetail_; }
+  // Particles of all emitters at the last update, and the cap then.
+  size_t live() const { return live_; }
+  size_t cap() const { return cap_; }
+
+private:
+  struct Entry {
+    Emitter *emitter;
+    int priority;
+  };
+
+  size_t maxParticles_;
+  float targetFrameTime_;
+  float frameTime_ = 0.0f; // Smoothed.
+  float levelOfDetail_ = 1.0f;
+  size_t live_ = 0;
+  size_t cap_ = 0;
+  std::vector<Entry> entries_; // Highest priority first.
+};
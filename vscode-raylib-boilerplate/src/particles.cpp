@@ -0,0 +1,29 @@
+#include "particles.h"
+
+void ParticleTextures::add(std::string name, Texture2D texture,
+                           Rectangle source) {
+  sprites_.insert_or_assign(std::move(name), ParticleSprite{texture, source});
+}
+
+const ParticleSprite *ParticleTextures::find(std::string_view name) const {
+  auto it = sprites_.find(name);
+  return it == sprites_.end() ? nullptr : &it->second;
+}
+
+const ParticleSprite &ParticleTextures::square(int size) {
+  auto [it, inserted] = squares_.try_emplace(size);
+  if (inserted) {
+    Image image = GenImageColor(size, size, WHITE);
+    it->second.texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+  }
+  return it->second;
+}
+
+void ParticleTextures::unload() {
+  for (auto &[size, sprite] : squares_) {
+    UnloadTexture(sprite.texture);
+  }
+  squares_.clear();
+  sprites_.clear();
+}
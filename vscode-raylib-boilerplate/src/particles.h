@@ -0,0 +1,366 @@
+#pragma once
+#include "../vendor/partikel.h"
+#include "profiler.h"
+#include "raylib.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+// C++ interface to the vendored libpartikel. Emitters are called directly,
+// without a C shim in between, and the partikel implementation is compiled
+// once in partikel.c.
+
+// ParticleSprite is what an emitter draws: a region of a texture.
+struct ParticleSprite {
+  Texture2D texture{};
+  Rectangle source{}; // Zero size for the whole texture.
+};
+
+// ParticleTextures names the sprites emitters draw, so emitters of the same
+// look share a texture instead of each uploading their own. Textures added
+// by name, e.g. atlas pages, stay owned by the caller. Squares are created
+// once per size and owned by the registry.
+class ParticleTextures {
+public:
+  ParticleTextures() = default;
+  ~ParticleTextures() { unload(); }
+
+  ParticleTextures(const ParticleTextures &) = delete;
+  ParticleTextures &operator=(const ParticleTextures &) = delete;
+
+  // Registers source of texture under name, replacing an earlier one.
+  void add(std::string name, Texture2D texture, Rectangle source = {});
+
+  // The sprite added under name, or nullptr.
+  const ParticleSprite *find(std::string_view name) const;
+
+  // A white square of size pixels. Needs a window.
+  const ParticleSprite &square(int size);
+
+  // Unloads the squares and forgets all sprites. The squares are the only
+  // textures the registry owns, and deleting them takes a GL context.
+  void unload();
+
+private:
+  struct Hash : std::hash<std::string_view> {
+    using is_transparent = void;
+  };
+  std::unordered_map<std::string, ParticleSprite, Hash, std::equal_to<>>
+      sprites_;
+  std::unordered_map<int, ParticleSprite> squares_;
+};
+
+// ParticleConfig builds an EmitterConfig. The defaults emit nothing until
+// configured: white particles that fade out over a second, without
+// velocity, stored as structure of arrays.
+//
+//   ParticleConfig().burst(10, 20).velocity(50, 150).sprite(spark)
+class ParticleConfig {
+public:
+  constexpr ParticleConfig() {
+    config_.direction = {1.0f, 0.0f};
+    config_.age = {1.0f, 1.0f};
+    config_.capacity = 100;
+    config_.startColor = {255, 255, 255, 255};
+    config_.endColor = {255, 255, 255, 0};
+    config_.blendMode = BLEND_ALPHA;
+    config_.particle_Deactivator = Particle_DeactivatorAge;
+    config_.storage = PARTICLE_STORAGE_SOA;
+  }
+
+  // The direction particles fly in, rotated by a random angle in degrees
+  // between min and max.
+  constexpr ParticleConfig &direction(Vector2 direction, float min = 0.0f,
+                                      float max = 0.0f) {
+    config_.direction = direction;
+    config_.directionAngle = {min, max};
+    return *this;
+  }
+  constexpr ParticleConfig &velocity(float min, float max) {
+    config_.velocity = {min, max};
+    return *this;
+  }
+  // A further random rotation of the velocity only, in degrees.
+  constexpr ParticleConfig &velocityAngle(float min, float max) {
+    config_.velocityAngle = {min, max};
+    return *this;
+  }
+  // How far from the origin particles spawn, along their direction.
+  constexpr ParticleConfig &offset(float min, float max) {
+    config_.offset = {min, max};
+    return *this;
+  }
+  // Towards the origin if negative, away from it if positive.
+  constexpr ParticleConfig &originAcceleration(float min, float max) {
+    config_.originAcceleration = {min, max};
+    return *this;
+  }
+  constexpr ParticleConfig &acceleration(Vector2 acceleration) {
+    config_.externalAcceleration = acceleration;
+    return *this;
+  }
+  constexpr ParticleConfig &burst(int min, int max) {
+    config_.burst = {min, max};
+    return *this;
+  }
+  constexpr ParticleConfig &capacity(size_t capacity) {
+    config_.capacity = capacity;
+    return *this;
+  }
+  // Particles per second while the emitter is started.
+  constexpr ParticleConfig &emissionRate(size_t rate) {
+    config_.emissionRate = rate;
+    return *this;
+  }
+  constexpr ParticleConfig &origin(Vector2 origin) {
+    config_.origin = origin;
+    return *this;
+  }
+  constexpr ParticleConfig &colors(Color start, Color end) {
+    config_.startColor = start;
+    config_.endColor = end;
+    return *this;
+  }
+  // Multi-stop gradients over the lifetime, baked into a lookup table when
+  // the emitter is created. colors replaces the start and end color, alpha
+  // multiplies it and scale sizes the sprite. Like the texture, the stops
+  // must outlive the emitter, e.g. be static constexpr arrays.
+  constexpr ParticleConfig &colors(std::span<const ColorStop> stops) {
+    config_.colors = {stops.data(), stops.size()};
+    return *this;
+  }
+  constexpr ParticleConfig &alpha(std::span<const FloatStop> stops) {
+    config_.alpha = {stops.data(), stops.size()};
+    return *this;
+  }
+  constexpr ParticleConfig &scale(std::span<const FloatStop> stops) {
+    config_.scale = {stops.data(), stops.size()};
+    return *this;
+  }
+  // Lifetime range in seconds.
+  constexpr ParticleConfig &age(float min, float max) {
+    config_.age = {min, max};
+    return *this;
+  }
+  constexpr ParticleConfig &blend(BlendMode mode) {
+    config_.blendMode = mode;
+    return *this;
+  }
+  constexpr ParticleConfig &sprite(const ParticleSprite &sprite) {
+    config_.texture = sprite.texture;
+    config_.source = sprite.source;
+    return *this;
+  }
+  // Equal seeds give equal particles. 0 takes a random seed.
+  constexpr ParticleConfig &seed(uint64_t seed) {
+    config_.seed = seed;
+    return *this;
+  }
+  constexpr ParticleConfig &storage(ParticleStorage storage) {
+    config_.storage = storage;
+    return *this;
+  }
+  // Replaces the age check. Emitters with a custom deactivator are updated
+  // particle by particle instead of in SIMD batches.
+  constexpr ParticleConfig &deactivator(bool (*deactivator)(Particle *)) {
+    config_.particle_Deactivator = deactivator;
+    return *this;
+  }
+
+  constexpr const EmitterConfig &get() const { return config_; }
+
+private:
+  EmitterConfig config_{};
+};
+
+// ParticleView is a read only view of the live particles of a structure of
+// arrays emitter, valid until its next update or burst.
+struct ParticleView {
+  std::span<const float> x;
+  std::span<const float> y;
+  std::span<const float> velocityX;
+  std::span<const float> velocityY;
+  std::span<const float> age;
+  std::span<const float> ttl;
+
+  size_t size() const { return x.size(); }
+};
+
+// ParticleEmitter owns an Emitter. It is move only, moving hands over the
+// particles without copying them. A moved from or default constructed
+// emitter is empty and must not be used other than assigned to.
+class ParticleEmitter {
+public:
+  ParticleEmitter() = default;
+  // Allocates all particles up front, from arena if given, so updating and
+  // bursting never allocate. Empty if the allocation failed.
+  explicit ParticleEmitter(const ParticleConfig &config,
+                           ParticleArena *arena = nullptr)
+      : emitter_(Emitter_NewInArena(arena, config.get())) {
+    if (emitter_ == nullptr) {
+      TraceLog(LOG_WARNING, "Cannot allocate an emitter of %zu particles",
+               config.get().capacity);
+    }
+  }
+  ~ParticleEmitter() { reset(); }
+
+  ParticleEmitter(ParticleEmitter &&other) noexcept
+      : emitter_(std::exchange(other.emitter_, nullptr)) {}
+  ParticleEmitter &operator=(ParticleEmitter &&other) noexcept {
+    if (this != &other) {
+      reset();
+      emitter_ = std::exchange(other.emitter_, nullptr);
+    }
+    return *this;
+  }
+  ParticleEmitter(const ParticleEmitter &) = delete;
+  ParticleEmitter &operator=(const ParticleEmitter &) = delete;
+
+  explicit operator bool() const { return emitter_ != nullptr; }
+
+  // Frees the particles, the emitter is empty afterwards.
+  void reset() {
+    if (emitter_ != nullptr) {
+      Emitter_Free(emitter_);
+      emitter_ = nullptr;
+    }
+  }
+
+  // Emits a burst at the origin, or at position.
+  void burst() { Emitter_Burst(emitter_); }
+  void burst(Vector2 position) {
+    emitter_->config.origin = position;
+    Emitter_Burst(emitter_);
+  }
+  // Starts and stops the continuous emission.
+  void start() { Emitter_Start(emitter_); }
+  void stop() { Emitter_Stop(emitter_); }
+  void setOrigin(Vector2 origin) { emitter_->config.origin = origin; }
+
+  // Advances the particles by dt seconds. Returns the live particle count.
+  size_t update(float dt) {
+    PROFILE_ZONE("particle update");
+    return Emitter_Update(emitter_, dt);
+  }
+
+  void draw() {
+    PROFILE_ZONE("particle draw");
+    Emitter_Draw(emitter_);
+  }
+  // Draws only the particles overlapping view, e.g. the screen.
+  void draw(Rectangle view) {
+    PROFILE_ZONE("particle draw");
+    Emitter_DrawInView(emitter_, view);
+  }
+
+  size_t size() const { return emitter_->length; }
+  size_t capacity() const { return emitter_->config.capacity; }
+  const EmitterConfig &config() const { return emitter_->config; }
+
+  // The live particles. Only for PARTICLE_STORAGE_SOA emitters.
+  ParticleView particles() const {
+    const ParticleSoA &soa = emitter_->soa;
+    size_t n = emitter_->length;
+    return {{soa.positionX, n}, {soa.positionY, n}, {soa.velocityX, n},
+            {soa.velocityY, n}, {soa.age, n},       {soa.ttl, n}};
+  }
+
+  // The live particles of a PARTICLE_STORAGE_AOS emitter.
+  std::span<Particle *const> particlesAos() const {
+    return {emitter_->particles, emitter_->length};
+  }
+
+  // For the partikel functions, e.g. ParticleSystem_Register. The emitter
+  // keeps owning it.
+  Emitter *get() const { return emitter_; }
+
+private:
+  Emitter *emitter_ = nullptr;
+};
+
+// ParticleForceField owns a ParticleField: attractors, repulsors and
+// vortices whose combined acceleration is rasterized into a coarse grid once
+// per frame and sampled by every particle. It acts on a ParticleSystem
+// through ParticleSystem_SetField, or on a PolicyEmitter through FieldForce.
+// Move only like ParticleEmitter.
+class ParticleForceField {
+public:
+  ParticleForceField() = default;
+  // Covers bounds with grid points cellSize pixels apart. Empty if the
+  // allocation failed.
+  ParticleForceField(Rectangle bounds, float cellSize)
+      : field_(ParticleField_New(bounds, cellSize)) {
+    if (field_ == nullptr) {
+      TraceLog(LOG_WARNING, "Cannot allocate a force field of %.0fx%.0f",
+               bounds.width, bounds.height);
+    }
+  }
+  ~ParticleForceField() { reset(); }
+
+  ParticleForceField(ParticleForceField &&other) noexcept
+      : field_(std::exchange(other.field_, nullptr)) {}
+  ParticleForceField &operator=(ParticleForceField &&other) noexcept {
+    if (this != &other) {
+      reset();
+      field_ = std::exchange(other.field_, nullptr);
+    }
+    return *this;
+  }
+  ParticleForceField(const ParticleForceField &) = delete;
+  ParticleForceField &operator=(const ParticleForceField &) = delete;
+
+  explicit operator bool() const { return field_ != nullptr; }
+
+  void reset() {
+    if (field_ != nullptr) {
+      ParticleField_Free(field_);
+      field_ = nullptr;
+    }
+  }
+
+  // Adds a force, the last one of forces() afterwards. Returns false if it
+  // cannot be allocated.
+  bool add(ParticleForce force) {
+    if (!ParticleField_Add(field_, force)) {
+      TraceLog(LOG_WARNING, "Cannot add force %zu to a force field",
+               field_->forceCount);
+      return false;
+    }
+    return true;
+  }
+  bool attractor(Vector2 position, float strength, float radius) {
+    return add({PARTICLE_FORCE_ATTRACTOR, position, strength, radius});
+  }
+  bool repulsor(Vector2 position, float strength, float radius) {
+    return add({PARTICLE_FORCE_REPULSOR, position, strength, radius});
+  }
+  bool vortex(Vector2 position, float strength, float radius) {
+    return add({PARTICLE_FORCE_VORTEX, position, strength, radius});
+  }
+  void clear() { ParticleField_Clear(field_); }
+
+  // The forces, to move or change them before the next rasterize.
+  std::span<ParticleForce> forces() {
+    return {field_->forces, field_->forceCount};
+  }
+
+  // Sums the forces into the grid. Once per frame, before the particles are
+  // updated. ParticleSystem updates do this themselves.
+  void rasterize() {
+    PROFILE_ZONE("force field");
+    ParticleField_Rasterize(field_);
+  }
+
+  Vector2 sample(Vector2 position) const {
+    return ParticleField_Sample(field_, position);
+  }
+
+  ParticleField *get() const { return field_; }
+
+private:
+  ParticleField *field_ = nullptr;
+};
@@ -0,0 +1,4 @@
+// The one translation unit compiling the libpartikel implementation. C++
+// code includes vendor/partikel.h, or particles.h, for the declarations.
+#define LIBPARTIKEL_IMPLEMENTATION
+#include "../vendor/partikel.h"
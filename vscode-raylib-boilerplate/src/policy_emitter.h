@@ -0,0 +1,228 @@
+#pragma once
+#include "particles.h"
+#include <cmath>
+#include <tuple>
+
+// PolicyEmitter is a ParticleEmitter whose update is compiled for its
+// effect. Which particles die and which forces act on them are template
+// parameters instead of the per particle deactivator function pointer of
+// partikel, so the whole update inlines into one loop the compiler
+// vectorizes, and forces an effect does not name cost nothing:
+//
+//   PolicyEmitter<AgeDeactivator, ConstantAcceleration> sparks(
+//       config, ConstantAcceleration{{0.0f, 50.0f}});
+//
+// A force is a copyable type with
+//
+//   void apply(ParticleState &p, float dt) const;
+//
+// that changes the velocity of p, and a deactivator one with
+//
+//   bool operator()(const ParticleState &p) const;
+//
+// that returns true for particles to remove. Both are called once per
+// particle and frame, so they should be small and free of branches.
+//
+// Spawning, bursts and drawing are partikel's. A PolicyEmitter of
+// AgeDeactivator with OriginAcceleration then ConstantAcceleration (the
+// config's external acceleration) moves its particles bit for bit like the
+// equivalent ParticleEmitter. config.externalAcceleration and
+// config.particle_Deactivator are not used, the policies replace them.
+
+// ParticleState is one particle while it is updated. Only the velocity is
+// meant to be changed by forces, the emitter integrates the position.
+struct ParticleState {
+  float x;
+  float y;
+  float velocityX;
+  float velocityY;
+  float originX;
+  float originY;
+  float originAcceleration;
+  float age; // Already advanced by this update.
+  float ttl;
+};
+
+// Deactivators
+
+// Removes particles older than their ttl, like Particle_DeactivatorAge.
+struct AgeDeactivator {
+  bool operator()(const ParticleState &p) const { return p.age > p.ttl; }
+};
+
+// Also removes particles that left bounds, e.g. the screen.
+struct BoundsDeactivator {
+  Rectangle bounds{};
+
+  bool operator()(const ParticleState &p) const {
+    bool outside = (p.x < bounds.x) | (p.y < bounds.y) |
+                   (p.x > bounds.x + bounds.width) |
+                   (p.y > bounds.y + bounds.height);
+    return (p.age > p.ttl) | outside;
+  }
+};
+
+// Forces
+
+// A constant acceleration in pixels per second squared, e.g. gravity.
+struct ConstantAcceleration {
+  Vector2 acceleration{};
+
+  void apply(ParticleState &p, float dt) const {
+    p.velocityX += acceleration.x * dt;
+    p.velocityY += acceleration.y * dt;
+  }
+};
+
+// Towards the origin, or away from it, by the particle's origin
+// acceleration (EmitterConfig::originAcceleration).
+struct OriginAcceleration {
+  void apply(ParticleState &p, float dt) const {
+    float dx = p.originX - p.x;
+    float dy = p.originY - p.y;
+    float length = std::sqrt(dx * dx + dy * dy);
+    // NormalizeV2 returns zero vectors unchanged.
+    bool zero = (dx == 0.0f) & (dy == 0.0f);
+    float tx = zero ? dx : dx / length;
+    float ty = zero ? dy : dy / length;
+    p.velocityX += tx * p.originAcceleration * dt;
+    p.velocityY += ty * p.originAcceleration * dt;
+  }
+};
+
+// Slows particles down by a fraction of their velocity per second.
+struct Drag {
+  float perSecond = 0.0f;
+
+  void apply(ParticleState &p, float dt) const {
+    float keep = 1.0f - perSecond * dt;
+    p.velocityX *= keep;
+    p.velocityY *= keep;
+  }
+};
+
+// The acceleration of a rasterized force field (ParticleForceField) at the
+// particle, sampled from its grid.
+struct FieldForce {
+  const ParticleField *field = nullptr;
+
+  void apply(ParticleState &p, float dt) const {
+    Vector2 a = ParticleField_Sample(field, {p.x, p.y});
+    p.velocityX += a.x * dt;
+    p.velocityY += a.y * dt;
+  }
+};
+
+template <typename Deactivator, typename... Forces> class PolicyEmitter {
+public:
+  PolicyEmitter() = default;
+  // config is always stored as structure of arrays.
+  explicit PolicyEmitter(ParticleConfig config, Forces... forces)
+      : emitter_(config.storage(PARTICLE_STORAGE_SOA)),
+        forces_(std::move(forces)...) {}
+  PolicyEmitter(ParticleConfig config, Deactivator deactivator,
+                Forces... forces)
+      : emitter_(config.storage(PARTICLE_STORAGE_SOA)),
+        deactivator_(std::move(deactivator)), forces_(std::move(forces)...) {}
+
+  explicit operator bool() const { return (bool)emitter_; }
+
+  void burst() { emitter_.burst(); }
+  void burst(Vector2 position) { emitter_.burst(position); }
+  void start() { emitter_.start(); }
+  void stop() { emitter_.stop(); }
+  void setOrigin(Vector2 origin) { emitter_.setOrigin(origin); }
+  void draw() { emitter_.draw(); }
+  void draw(Rectangle view) { emitter_.draw(view); }
+
+  // Advances the particles by dt seconds and emits the ones due. Returns
+  // the live particle count.
+  size_t update(float dt) {
+    PROFILE_ZONE("particle update");
+    Emitter *e = emitter_.get();
+    integrate(0, e->length, dt);
+    removeDead(0);
+    size_t begin = e->length;
+    if (Emitter_Emit(e, dt) > 0) {
+      integrate(begin, e->length, dt);
+      removeDead(begin);
+    }
+    return e->length;
+  }
+
+  size_t size() const { return emitter_.size(); }
+  size_t capacity() const { return emitter_.capacity(); }
+  ParticleView particles() const { return emitter_.particles(); }
+
+  // The policies, to change e.g. an acceleration between updates.
+  Deactivator &deactivator() { return deactivator_; }
+  template <typename Force> Force &force() { return std::get<Force>(forces_); }
+
+  Emitter *get() const { return emitter_.get(); }
+
+private:
+  // Steps particles [begin, end) and marks the dead ones inactive.
+  void integrate(size_t begin, size_t end, float dt) {
+    ParticleSoA &soa = emitter_.get()->soa;
+    integrate(soa.positionX + begin, soa.positionY + begin,
+              soa.velocityX + begin, soa.velocityY + begin, soa.age + begin,
+              soa.active + begin, soa.originX + begin, soa.originY + begin,
+              soa.originAcceleration + begin, soa.ttl + begin, end - begin,
+              dt, deactivator_, forces_);
+  }
+
+  // The restrict parameters promise that no two arrays overlap, and the
+  // policies are copies, so the stores cannot change them either. Whether the
+  // loop vectorizes depends on the policies: with ConstantAcceleration and
+  // AgeDeactivator GCC -O3 vectorizes it, the grid lookups of FieldForce keep
+  // it scalar.
+  static void integrate(float *__restrict x, float *__restrict y,
+                        float *__restrict vx, float *__restrict vy,
+                        float *__restrict age, bool *__restrict active,
+                        const float *__restrict originX,
+                        const float *__restrict originY,
+                        const float *__restrict originAcceleration,
+                        const float *__restrict ttl, size_t n, float dt,
+                        const Deactivator deactivator,
+                        const std::tuple<Forces...> forces) {
+    for (size_t i = 0; i < n; i++) {
+      ParticleState p = {.x = x[i],
+                         .y = y[i],
+                         .velocityX = vx[i],
+                         .velocityY = vy[i],
+                         .originX = originX[i],
+                         .originY = originY[i],
+                         .originAcceleration = originAcceleration[i],
+                         .age = age[i] + dt,
+                         .ttl = ttl[i]};
+      std::apply([&](const Forces &...force) { (force.apply(p, dt), ...); },
+                 forces);
+      p.x += p.velocityX * dt;
+      p.y += p.velocityY * dt;
+      x[i] = p.x;
+      y[i] = p.y;
+      vx[i] = p.velocityX;
+      vy[i] = p.velocityY;
+      age[i] = p.age;
+      active[i] = !deactivator(p);
+    }
+  }
+
+  // Swaps the particles marked dead from begin on out of the live range.
+  void removeDead(size_t begin) {
+    Emitter *e = emitter_.get();
+    const bool *active = e->soa.active;
+    size_t i = begin;
+    while (i < e->length) {
+      if (active[i]) {
+        i++;
+      } else {
+        Emitter_RemoveAt(e, i);
+      }
+    }
+  }
+
+  ParticleEmitter emitter_;
+  [[no_unique_address]] Deactivator deactivator_{};
+  std::tuple<Forces...> forces_;
+};
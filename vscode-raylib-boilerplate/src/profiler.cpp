@@ -0,0 +1,276 @@
+#include "profiler.h"
+
+#if defined(PROFILER_ENABLED)
+#include "fixed_timestep.h"
+#include "raylib.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kMaxDepth = 32;
+constexpr size_t kEventsPerThread = 8192;
+// Weight of the latest frame in the averages shown by the overlay.
+constexpr double kAverageWeight = 0.05;
+
+struct ZoneEvent {
+  const char *name = nullptr;
+  int64_t begin = 0; // Nanoseconds since the profiler started.
+  int64_t end = 0;
+  uint32_t depth = 0;
+};
+
+// ThreadLog belongs to one thread, which pushes its finished zones. The
+// main thread pops them in endFrame(). When the main thread falls behind,
+// zones are dropped instead of blocking the recording thread.
+struct ThreadLog {
+  SpscQueue<ZoneEvent, kEventsPerThread> events;
+  std::atomic<uint64_t> dropped{0};
+  uint32_t id = 0;
+  // Owner thread only
+  uint32_t depth = 0;
+  std::array<ZoneEvent, kMaxDepth> open{};
+};
+
+// All thread logs, kept until exit so the zones of finished threads can
+// still be collected. The lock is only taken when a thread records its
+// first zone and by the main thread once per frame.
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadLog>> logs;
+};
+
+Registry &registry() {
+  static Registry registry;
+  return registry;
+}
+
+int64_t now() {
+  static const SimClock::time_point start = SimClock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(SimClock::now() -
+                                                              start)
+      .count();
+}
+
+ThreadLog &threadLog() {
+  thread_local ThreadLog *log = [] {
+    Registry &r = registry();
+    std::lock_guard lock(r.mutex);
+    ThreadLog *created =
+        r.logs.emplace_back(std::make_unique<ThreadLog>()).get();
+    created->id = (uint32_t)r.logs.size() - 1;
+    return created;
+  }();
+  return *log;
+}
+
+// ZoneStats is a row of the overlay, a zone name at a depth on a thread.
+struct ZoneStats {
+  uint32_t thread;
+  uint32_t depth;
+  std::string_view name;
+  int64_t firstBegin;
+  int64_t frameNanoseconds = 0;
+  double averageMs = 0.0;
+};
+
+struct TraceEvent {
+  ZoneEvent zone;
+  uint32_t thread;
+};
+
+// Main thread only
+struct Collector {
+  uint32_t mainThread = 0;
+  std::vector<ZoneStats> zones;
+  int64_t lastFrame = -1;
+  double frameMs = 0.0;
+  uint64_t dropped = 0;
+
+  bool tracing = false;
+  size_t maxTraceEvents = 0;
+  std::vector<TraceEvent> trace;
+};
+
+Collector collector;
+
+void record(uint32_t thread, const ZoneEvent &event) {
+  auto matches = [&](const ZoneStats &zone) {
+    return zone.thread == thread && zone.depth == event.depth &&
+           zone.name == event.name;
+  };
+  auto stats =
+      std::find_if(collector.zones.begin(), collector.zones.end(), matches);
+  if (stats == collector.zones.end()) {
+    collector.zones.push_back({.thread = thread,
+                               .depth = event.depth,
+                               .name = event.name,
+                               .firstBegin = event.begin});
+    // Parents begin before their children, so this lists them first.
+    std::sort(collector.zones.begin(), collector.zones.end(),
+              [](const ZoneStats &a, const ZoneStats &b) {
+                return a.thread != b.thread ? a.thread < b.thread
+                                            : a.firstBegin < b.firstBegin;
+              });
+    stats =
+        std::find_if(collector.zones.begin(), collector.zones.end(), matches);
+  }
+  stats->frameNanoseconds += event.end - event.begin;
+
+  if (collector.tracing && collector.trace.size() < collector.maxTraceEvents) {
+    collector.trace.push_back({event, thread});
+  }
+}
+
+// Writes s as a JSON string.
+void writeString(FILE *file, std::string_view s) {
+  std::fputc('"', file);
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      std::fputc('\\', file);
+    }
+    std::fputc(c, file);
+  }
+  std::fputc('"', file);
+}
+
+} // namespace
+
+extern "C" void Profiler_Begin(const char *name) {
+  ThreadLog &log = threadLog();
+  if (log.depth < kMaxDepth) {
+    log.open[log.depth] = {.name = name, .begin = now(), .depth = log.depth};
+  }
+  log.depth++;
+}
+
+extern "C" void Profiler_End(void) {
+  ThreadLog &log = threadLog();
+  if (log.depth == 0) {
+    return;
+  }
+  log.depth--;
+  if (log.depth >= kMaxDepth) {
+    return; // Too deep to be recorded.
+  }
+  ZoneEvent event = log.open[log.depth];
+  event.end = now();
+  if (!log.events.push(event)) {
+    log.dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void Profiler::endFrame() {
+  collector.mainThread = threadLog().id;
+  for (ZoneStats &zone : collector.zones) {
+    zone.frameNanoseconds = 0;
+  }
+
+  {
+    Registry &r = registry();
+    std::lock_guard lock(r.mutex);
+    collector.dropped = 0;
+    for (const std::unique_ptr<ThreadLog> &log : r.logs) {
+      while (auto event = log->events.pop()) {
+        record(log->id, *event);
+      }
+      collector.dropped += log->dropped.load(std::memory_order_relaxed);
+    }
+  }
+
+  for (ZoneStats &zone : collector.zones) {
+    zone.averageMs += (zone.frameNanoseconds / 1e6 - zone.averageMs) *
+                      kAverageWeight;
+  }
+  int64_t frame = now();
+  if (collector.lastFrame >= 0) {
+    collector.frameMs += ((frame - collector.lastFrame) / 1e6 -
+                          collector.frameMs) *
+                         kAverageWeight;
+  }
+  collector.lastFrame = frame;
+}
+
+void Profiler::drawOverlay(int x, int y) {
+  const int fontSize = 10;
+  const int lineHeight = 12;
+  int lines = (int)collector.zones.size() + 1 + (collector.dropped > 0);
+  DrawRectangle(x, y, 260, lines * lineHeight + 8, Fade(BLACK, 0.7f));
+  x += 4;
+  y += 4;
+
+  DrawText(TextFormat("frame %6.2f ms", collector.frameMs), x, y, fontSize,
+           RAYWHITE);
+  y += lineHeight;
+  for (const ZoneStats &zone : collector.zones) {
+    int indent = (int)zone.depth * 8;
+    Color color = zone.thread == collector.mainThread ? RAYWHITE : SKYBLUE;
+    DrawText(TextFormat("%.*s", (int)zone.name.size(), zone.name.data()),
+             x + indent, y, fontSize, color);
+    DrawText(TextFormat("%6.2f ms", zone.averageMs), x + 190, y, fontSize,
+             color);
+    y += lineHeight;
+  }
+  if (collector.dropped > 0) {
+    DrawText(TextFormat("%llu zones dropped",
+                        (unsigned long long)collector.dropped),
+             x, y, fontSize, ORANGE);
+  }
+}
+
+void Profiler::startTrace(size_t maxEvents) {
+  collector.tracing = true;
+  collector.maxTraceEvents = maxEvents;
+  collector.trace.clear();
+}
+
+bool Profiler::writeTrace(const std::string &path) {
+  endFrame(); // Include the zones of the last frame.
+
+  FILE *file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    TraceLog(LOG_WARNING, "Cannot write profiler trace %s", path.c_str());
+    return false;
+  }
+  std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  const char *separator = "\n";
+  uint32_t threads = 0;
+  for (const TraceEvent &event : collector.trace) {
+    threads = std::max(threads, event.thread + 1);
+  }
+  for (uint32_t thread = 0; thread < threads; thread++) {
+    std::fprintf(file,
+                 "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+                 "\"tid\":%u,\"args\":{\"name\":",
+                 separator, thread);
+    writeString(file, thread == collector.mainThread
+                          ? "main"
+                          : TextFormat("thread %u", thread));
+    std::fprintf(file, "}}");
+    separator = ",\n";
+  }
+  for (const TraceEvent &event : collector.trace) {
+    std::fprintf(file, "%s{\"name\":", separator);
+    writeString(file, event.zone.name);
+    std::fprintf(file,
+                 ",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,"
+                 "\"dur\":%.3f}",
+                 event.thread, event.zone.begin / 1e3,
+                 (event.zone.end - event.zone.begin) / 1e3);
+    separator = ",\n";
+  }
+  std::fprintf(file, "\n]}\n");
+  bool written = std::ferror(file) == 0;
+  written = std::fclose(file) == 0 && written;
+  TraceLog(LOG_INFO, "Wrote %zu profiler zones to %s", collector.trace.size(),
+           path.c_str());
+  return written;
+}
+#endif
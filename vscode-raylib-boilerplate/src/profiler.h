@@ -0,0 +1,81 @@
+#pragma once
+
+// A scoped CPU profiler for C and C++. Zones are recorded per thread into a
+// lock-free ring buffer, the main thread collects them once per frame for
+// the overlay and, if a trace is running, for a Chrome trace file that can
+// be opened in chrome://tracing or https://ui.perfetto.dev.
+//
+// It is built with PROFILER_ENABLED defined. Without it every macro and
+// function below compiles to nothing.
+//
+//   C:   PROFILE_BEGIN("particle update"); ... PROFILE_END();
+//   C++: PROFILE_ZONE("update");  // Ends with the enclosing scope.
+//
+// Zone names must be string literals, or otherwise outlive the profiler.
+
+#if defined(PROFILER_ENABLED)
+#ifdef __cplusplus
+extern "C" {
+#endif
+void Profiler_Begin(const char *name);
+void Profiler_End(void);
+#ifdef __cplusplus
+}
+#endif
+#define PROFILE_BEGIN(name) Profiler_Begin(name)
+#define PROFILE_END() Profiler_End()
+#else
+#define PROFILE_BEGIN(name) ((void)0)
+#define PROFILE_END() ((void)0)
+#endif
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <string>
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#if defined(PROFILER_ENABLED)
+// ProfileZone records the time between its construction and destruction.
+class ProfileZone {
+public:
+  explicit ProfileZone(const char *name) { Profiler_Begin(name); }
+  ~ProfileZone() { Profiler_End(); }
+
+  ProfileZone(const ProfileZone &) = delete;
+  ProfileZone &operator=(const ProfileZone &) = delete;
+};
+#define PROFILE_ZONE(name)                                                     \
+  ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
+
+// Profiler collects and presents the zones. All functions must be called
+// from the main thread.
+class Profiler {
+public:
+#if defined(PROFILER_ENABLED)
+  // Collects the zones recorded since the last call. Call once per frame,
+  // after EndDrawing.
+  static void endFrame();
+
+  // Draws the average time per zone over the last frames, nested zones
+  // indented. Call between BeginDrawing and EndDrawing.
+  static void drawOverlay(int x, int y);
+
+  // Keeps the zones collected from now on, up to maxEvents, for writeTrace.
+  static void startTrace(size_t maxEvents = 1 << 20);
+
+  // Writes the kept zones as Chrome trace JSON. Returns false if the file
+  // cannot be written.
+  static bool writeTrace(const std::string &path);
+#else
+  static void endFrame() {}
+  static void drawOverlay(int, int) {}
+  static void startTrace(size_t = 0) {}
+  static bool writeTrace(const std::string &) { return false; }
+#endif
+};
+#endif
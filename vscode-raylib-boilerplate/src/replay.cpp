@@ -0,0 +1,55 @@
+#include "replay.h"
+#include <filesystem>
+#include <fstream>
+
+// Recording over an existing replay only replaces it once the new one is
+// complete, so a failed write, e.g. on a full disk, keeps the old one.
+bool Replay::save(const std::string &path) const {
+  ReplayHeader written = header;
+  written.magic = kReplayMagic;
+  written.version = kReplayVersion;
+  written.frameCount = (uint32_t)frames.size();
+
+  std::string temporary = path + ".tmp";
+  bool ok;
+  {
+    std::ofstream file(temporary, std::ios::binary);
+    file.write((const char *)&written, sizeof(written));
+    file.write((const char *)frames.data(),
+               (std::streamsize)(frames.size() * sizeof(ReplayFrame)));
+    ok = (bool)file;
+  }
+  std::error_code error;
+  if (ok) {
+    std::filesystem::rename(temporary, path, error);
+    ok = !error;
+  } else {
+    std::filesystem::remove(temporary, error);
+  }
+  if (!ok) {
+    TraceLog(LOG_WARNING, "Cannot write replay %s", path.c_str());
+    return false;
+  }
+  TraceLog(LOG_INFO, "Recorded %zu frames to %s", frames.size(), path.c_str());
+  return true;
+}
+
+bool Replay::load(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.read((char *)&header, sizeof(header))) {
+    TraceLog(LOG_WARNING, "Cannot read replay %s", path.c_str());
+    return false;
+  }
+  if (header.magic != kReplayMagic || header.version != kReplayVersion) {
+    TraceLog(LOG_WARNING, "%s is not a replay of this version", path.c_str());
+    return false;
+  }
+  frames.resize(header.frameCount);
+  if (!file.read((char *)frames.data(),
+                 (std::streamsize)(frames.size() * sizeof(ReplayFrame)))) {
+    TraceLog(LOG_WARNING, "Replay %s is truncated", path.c_str());
+    frames.clear();
+    return false;
+  }
+  return true;
+}
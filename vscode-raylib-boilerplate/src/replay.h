@@ -0,0 +1,71 @@
+#pragma once
+#include "raylib.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Replay file format, written with --record and read with --replay:
+//
+//   ReplayHeader
+//   ReplayFrame[frameCount]
+//
+// A replay holds what a run depends on besides the binary: the seed, the
+// world setup and every frame's input. Replaying the inputs with the same
+// build reproduces the run bit for bit, which the checksum of the
+// simulated state after each frame verifies.
+
+constexpr uint32_t kReplayMagic = 0x594c5052; // "RPLY"
+// Bump whenever the format or the simulation changes, so replays recorded
+// with an older build are rejected instead of diverging.
+constexpr uint32_t kReplayVersion = 3;
+
+// Bits of FrameInput::buttons
+constexpr uint32_t kInputToggleProfiler = 1u << 0;
+constexpr uint32_t kInputBurst = 1u << 1;
+
+// FrameInput is everything a frame reads from the user.
+struct FrameInput {
+  float frameTime = 0.0f;
+  uint32_t buttons = 0;
+  Vector2 pointer{};
+};
+
+struct ReplayHeader {
+  uint32_t magic = kReplayMagic;
+  uint32_t version = kReplayVersion;
+  uint64_t seed = 0;
+  float simulationHz = 0.0f;
+  int32_t ketCount = 0;
+  Vector2 bounds{};
+  Vector2 ketSize{};
+  uint32_t frameCount = 0;
+  uint32_t reserved = 0;
+};
+
+struct ReplayFrame {
+  FrameInput input;
+  uint64_t checksum = 0;
+};
+
+static_assert(sizeof(ReplayHeader) == 48 && sizeof(ReplayFrame) == 24,
+              "replay files are read and written as raw structs");
+
+struct Replay {
+  ReplayHeader header;
+  std::vector<ReplayFrame> frames;
+
+  // Both return false, and log why, if the file cannot be read or written.
+  bool save(const std::string &path) const;
+  bool load(const std::string &path);
+};
+
+// Folds the bits of values into an FNV-1a hash, for ReplayFrame::checksum.
+inline uint64_t hashFloats(std::span<const float> values,
+                           uint64_t hash = 0xcbf29ce484222325ull) {
+  const unsigned char *bytes = (const unsigned char *)values.data();
+  for (size_t i = 0; i < values.size_bytes(); i++) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
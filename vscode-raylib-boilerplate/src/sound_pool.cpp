@@ -0,0 +1,56 @@
+#include "sound_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+void SoundPool::clear() {
+  for (Sample &sample : samples_) {
+    for (Sound &voice : sample.voices) {
+      UnloadSoundAlias(voice);
+    }
+  }
+  samples_.clear();
+}
+
+int SoundPool::add(Sound source, int voices) {
+  Sample sample;
+  for (int i = 0; i < std::max(voices, 1); i++) {
+    sample.voices.push_back(LoadSoundAlias(source));
+    sample.startTimes.push_back(0.0);
+  }
+  samples_.push_back(std::move(sample));
+  return (int)samples_.size() - 1;
+}
+
+void SoundPool::flush() {
+  int budget = playsPerFrame_;
+  for (Sample &sample : samples_) {
+    if (sample.pendingCount > 0 && budget > 0) {
+      // Triggers of the same frame add up like uncorrelated sources, so
+      // their energies are summed.
+      play(sample, std::min(std::sqrt(sample.pendingEnergy), 1.0f));
+      budget--;
+    }
+    sample.pendingCount = 0;
+    sample.pendingEnergy = 0.0f;
+  }
+}
+
+// Plays on a free voice, or restarts the voice that started first.
+void SoundPool::play(Sample &sample, float volume) {
+  size_t voice = 0;
+  for (size_t i = 0; i < sample.voices.size(); i++) {
+    if (!IsSoundPlaying(sample.voices[i])) {
+      voice = i;
+      break;
+    }
+    if (sample.startTimes[i] < sample.startTimes[voice]) {
+      voice = i;
+    }
+  }
+
+  Sound &sound = sample.voices[voice];
+  SetSoundVolume(sound, volume);
+  PlaySound(sound); // Restarts the voice if it is still playing.
+  sample.startTimes[voice] = GetTime();
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "raylib.h"
+#include <vector>
+
+// SoundPool plays many triggers of a few samples with a fixed amount of
+// voices. Each sample gets its voices as aliases made with LoadSoundAlias,
+// so they share the sample data but can play at the same time.
+//
+// trigger() only records the request. flush(), called once per frame,
+// merges all triggers of a sample into one play with a volume scaled by
+// their count, limits the plays per frame and steals the oldest voice of a
+// sample when all of them are busy. The audio calls per frame are therefore
+// bounded by the amount of voices, not by the amount of triggers.
+class SoundPool {
+public:
+  explicit SoundPool(int playsPerFrame = 8) : playsPerFrame_(playsPerFrame) {}
+  ~SoundPool() { clear(); }
+
+  SoundPool(const SoundPool &) = delete;
+  SoundPool &operator=(const SoundPool &) = delete;
+
+  // Adds a sample with the given amount of voices and returns its id. The
+  // source sound stays owned by the caller and must stay loaded until the
+  // pool is cleared or destroyed.
+  int add(Sound source, int voices);
+
+  // Requests the sample to be played at volume within this frame.
+  void trigger(int sample, float volume = 1.0f) {
+    Sample &s = samples_[sample];
+    s.pendingCount++;
+    s.pendingEnergy += volume * volume;
+  }
+
+  // Plays the triggers of this frame.
+  void flush();
+
+  // Unloads all voices and removes all samples.
+  void clear();
+
+private:
+  struct Sample {
+    std::vector<Sound> voices;
+    std::vector<double> startTimes;
+    int pendingCount = 0;
+    float pendingEnergy = 0.0f; // Sum of the squared volumes.
+  };
+
+  void play(Sample &sample, float volume);
+
+  int playsPerFrame_;
+  std::vector<Sample> samples_;
+};
@@ -0,0 +1,129 @@
+#include "sprite_batch.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Vertices reserved per rlCheckRenderBatchLimit call are 4 times this.
+constexpr size_t kSubmitChunk = 1024;
+
+int blendOf(uint32_t key) { return (int)((key >> 16) & 0xff); }
+uint32_t pageOf(uint32_t key) { return key & 0xffff; }
+
+} // namespace
+
+void SpriteBatch::draw(uint32_t region, Rectangle dest, Vector2 origin,
+                       float rotation, Color tint, BlendMode blend,
+                       uint8_t layer) {
+  const AtlasRegion &r = atlas_.region(region);
+  Sprite &sprite = sprites_.emplace_back();
+  sprite.uv = r.uv;
+  sprite.tint = tint;
+  sprite.key = (uint32_t)layer << 24 | ((uint32_t)blend & 0xff) << 16 |
+               (r.page & 0xffff);
+
+  // The same corners as DrawTexturePro.
+  Vector2 *corners = sprite.corners;
+  if (rotation == 0.0f) {
+    float x = dest.x - origin.x;
+    float y = dest.y - origin.y;
+    corners[0] = {x, y};
+    corners[1] = {x, y + dest.height};
+    corners[2] = {x + dest.width, y + dest.height};
+    corners[3] = {x + dest.width, y};
+  } else {
+    float s = std::sin(rotation * DEG2RAD);
+    float c = std::cos(rotation * DEG2RAD);
+    float left = -origin.x;
+    float top = -origin.y;
+    float right = left + dest.width;
+    float bottom = top + dest.height;
+    corners[0] = {dest.x + left * c - top * s, dest.y + left * s + top * c};
+    corners[1] = {dest.x + left * c - bottom * s,
+                  dest.y + left * s + bottom * c};
+    corners[2] = {dest.x + right * c - bottom * s,
+                  dest.y + right * s + bottom * c};
+    corners[3] = {dest.x + right * c - top * s, dest.y + right * s + top * c};
+  }
+}
+
+void SpriteBatch::flush() {
+  size_t n = sprites_.size();
+  if (n == 0) {
+    return;
+  }
+
+  // A frame has few distinct keys, so the sprites are counting sorted by
+  // key, which keeps their order within a key.
+  keys_.clear();
+  for (const Sprite &sprite : sprites_) {
+    if (std::find(keys_.begin(), keys_.end(), sprite.key) == keys_.end()) {
+      keys_.push_back(sprite.key);
+    }
+  }
+  std::sort(keys_.begin(), keys_.end());
+
+  buckets_.resize(n);
+  counts_.assign(keys_.size() + 1, 0);
+  uint32_t lastKey = keys_[0];
+  uint32_t lastBucket = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint32_t key = sprites_[i].key;
+    if (key != lastKey) {
+      lastKey = key;
+      lastBucket = (uint32_t)(std::lower_bound(keys_.begin(), keys_.end(),
+                                               key) -
+                              keys_.begin());
+    }
+    buckets_[i] = lastBucket;
+    counts_[lastBucket + 1]++;
+  }
+  for (size_t bucket = 1; bucket < counts_.size(); bucket++) {
+    counts_[bucket] += counts_[bucket - 1];
+  }
+  order_.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    order_[counts_[buckets_[i]]++] = (uint32_t)i;
+  }
+
+  // counts_[bucket] is now where the next bucket starts.
+  int blend = -1;
+  size_t begin = 0;
+  for (size_t bucket = 0; bucket < keys_.size(); bucket++) {
+    uint32_t key = keys_[bucket];
+    size_t end = counts_[bucket];
+    if (blendOf(key) != blend) {
+      blend = blendOf(key);
+      BeginBlendMode(blend);
+    }
+    rlSetTexture(atlas_.page(pageOf(key)).id);
+    rlBegin(RL_QUADS);
+    rlNormal3f(0.0f, 0.0f, 1.0f);
+    for (size_t i = begin; i < end; i++) {
+      if ((i - begin) % kSubmitChunk == 0) {
+        rlCheckRenderBatchLimit((int)(4 * std::min(end - i, kSubmitChunk)));
+      }
+      const Sprite &sprite = sprites_[order_[i]];
+      const Vector2 *corners = sprite.corners;
+      float u0 = sprite.uv.x;
+      float v0 = sprite.uv.y;
+      float u1 = u0 + sprite.uv.width;
+      float v1 = v0 + sprite.uv.height;
+      rlColor4ub(sprite.tint.r, sprite.tint.g, sprite.tint.b, sprite.tint.a);
+      rlTexCoord2f(u0, v0);
+      rlVertex2f(corners[0].x, corners[0].y);
+      rlTexCoord2f(u0, v1);
+      rlVertex2f(corners[1].x, corners[1].y);
+      rlTexCoord2f(u1, v1);
+      rlVertex2f(corners[2].x, corners[2].y);
+      rlTexCoord2f(u1, v0);
+      rlVertex2f(corners[3].x, corners[3].y);
+    }
+    rlEnd();
+    begin = end;
+  }
+  rlSetTexture(0);
+  EndBlendMode();
+  sprites_.clear();
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "raylib.h"
+#include "texture_atlas.h"
+#include <cstdint>
+#include <vector>
+
+// SpriteBatch collects sprites drawn from a TextureAtlas during a frame and
+// submits them in flush(), grouped by layer, blend mode and atlas page. Each
+// group is one run of quads through rlgl, so the texture and blend mode
+// only change between groups instead of between sprites.
+//
+// Lower layers are drawn first. Within a group, sprites keep the order they
+// were drawn in. Across groups of the same layer, the order is by blend mode
+// and page, so sprites that must overlap in a given order need their own
+// layers.
+class SpriteBatch {
+public:
+  explicit SpriteBatch(const TextureAtlas &atlas) : atlas_(atlas) {}
+
+  // Queues region of the atlas like DrawTexturePro: dest is where origin
+  // of the sprite goes, rotation is in degrees around origin.
+  void draw(uint32_t region, Rectangle dest, Vector2 origin, float rotation,
+            Color tint, BlendMode blend = BLEND_ALPHA, uint8_t layer = 0);
+
+  // Submits and clears the queued sprites. Call between BeginDrawing and
+  // EndDrawing.
+  void flush();
+
+  size_t size() const { return sprites_.size(); }
+
+private:
+  // Sprite holds the corners in submission order: top left, bottom left,
+  // bottom right, top right.
+  struct Sprite {
+    Vector2 corners[4];
+    Rectangle uv;
+    Color tint;
+    uint32_t key; // layer, blend mode, page, from high to low bits
+  };
+
+  const TextureAtlas &atlas_;
+  std::vector<Sprite> sprites_;
+  // Scratch for flush()
+  std::vector<uint32_t> keys_;
+  std::vector<uint32_t> buckets_;
+  std::vector<uint32_t> counts_;
+  std::vector<uint32_t> order_;
+};
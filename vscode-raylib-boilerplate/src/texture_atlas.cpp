@@ -0,0 +1,148 @@
+#include "texture_atlas.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace {
+
+// Shelf is the page being filled, row by row, left to right.
+struct Shelf {
+  int width = 0; // Used so far, the page is cropped to it.
+  int height = 0;
+  int x = 0; // Next free position on the current row.
+  int y = 0;
+  int rowHeight = 0;
+};
+
+// Copies the RGBA pixels of image to (x, y) of page and repeats its border
+// padding pixels outwards.
+void blit(Image &page, const Image &image, int x, int y, int padding) {
+  const uint32_t *source = (const uint32_t *)image.data;
+  uint32_t *target = (uint32_t *)page.data;
+  for (int row = -padding; row < image.height + padding; row++) {
+    int sourceRow = std::min(std::max(row, 0), image.height - 1);
+    const uint32_t *from = source + (size_t)sourceRow * image.width;
+    uint32_t *to = target + (size_t)(y + row) * page.width + x;
+    for (int column = -padding; column < 0; column++) {
+      to[column] = from[0];
+    }
+    std::memcpy(to, from, (size_t)image.width * sizeof(uint32_t));
+    for (int column = image.width; column < image.width + padding; column++) {
+      to[column] = from[image.width - 1];
+    }
+  }
+}
+
+} // namespace
+
+uint32_t TextureAtlas::add(const Image &image) {
+  Image copy{};
+  if (image.data != nullptr && image.width > 0 && image.height > 0) {
+    copy = ImageCopy(image);
+    ImageFormat(&copy, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+  }
+  images_.push_back(copy);
+  regions_.emplace_back();
+  return (uint32_t)regions_.size() - 1;
+}
+
+bool TextureAtlas::build() {
+  bool built = true;
+  std::vector<uint32_t> order(images_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+    return images_[a].height > images_[b].height;
+  });
+
+  // Place the images, tallest first, so each row wastes little height.
+  std::vector<Shelf> shelves;
+  std::vector<Vector2> positions(images_.size());
+  for (uint32_t index : order) {
+    const Image &image = images_[index];
+    if (image.data == nullptr) {
+      built = false;
+      continue;
+    }
+    int width = image.width + 2 * padding_;
+    int height = image.height + 2 * padding_;
+
+    Shelf *target = nullptr;
+    bool oversized = width > pageSize_ || height > pageSize_;
+    // An image larger than a page gets a page of its own.
+    for (size_t i = 0; !oversized && i < shelves.size(); i++) {
+      Shelf &shelf = shelves[i];
+      if (shelf.x + width > pageSize_) {
+        // Start a new row below the current one.
+        if (shelf.y + shelf.rowHeight + height <= pageSize_) {
+          shelf.y += shelf.rowHeight;
+          shelf.x = 0;
+          shelf.rowHeight = 0;
+        } else {
+          continue;
+        }
+      }
+      if (shelf.y + height <= pageSize_) {
+        target = &shelf;
+        break;
+      }
+    }
+    if (target == nullptr) {
+      target = &shelves.emplace_back();
+    }
+
+    regions_[index].page = (uint32_t)(target - shelves.data());
+    positions[index] = {(float)(target->x + padding_),
+                        (float)(target->y + padding_)};
+    target->x += width;
+    target->rowHeight = std::max(target->rowHeight, height);
+    target->width = std::max(target->width, target->x);
+    target->height = std::max(target->height, target->y + target->rowHeight);
+    if (oversized) {
+      target->y = pageSize_; // Keep the page to itself.
+    }
+  }
+
+  // Compose and upload each page, cropped to what it holds.
+  for (uint32_t page = 0; page < shelves.size(); page++) {
+    const Shelf &shelf = shelves[page];
+    Image pixels = GenImageColor(shelf.width, shelf.height, BLANK);
+    for (uint32_t index = 0; index < images_.size(); index++) {
+      if (images_[index].data == nullptr || regions_[index].page != page) {
+        continue;
+      }
+      const Image &image = images_[index];
+      blit(pixels, image, (int)positions[index].x, (int)positions[index].y,
+           padding_);
+      regions_[index].source = {positions[index].x, positions[index].y,
+                                (float)image.width, (float)image.height};
+      regions_[index].uv = {positions[index].x / shelf.width,
+                            positions[index].y / shelf.height,
+                            (float)image.width / shelf.width,
+                            (float)image.height / shelf.height};
+    }
+    Texture2D texture = LoadTextureFromImage(pixels);
+    UnloadImage(pixels);
+    built = built && texture.id > 0;
+    pages_.push_back(texture);
+  }
+
+  for (Image &image : images_) {
+    UnloadImage(image);
+  }
+  images_.clear();
+  TraceLog(LOG_INFO, "Texture atlas: %zu images on %zu pages",
+           regions_.size(), pages_.size());
+  return built;
+}
+
+void TextureAtlas::unload() {
+  for (Texture2D &page : pages_) {
+    UnloadTexture(page);
+  }
+  pages_.clear();
+  for (Image &image : images_) {
+    UnloadImage(image);
+  }
+  images_.clear();
+  regions_.clear();
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "raylib.h"
+#include <cstdint>
+#include <vector>
+
+// AtlasRegion is where an image ended up in a TextureAtlas.
+struct AtlasRegion {
+  uint32_t page = 0;
+  Rectangle source{}; // In pixels of the page, for DrawTexturePro.
+  Rectangle uv{};     // The same, normalized to the page size.
+};
+
+// TextureAtlas packs images into a few shared textures, so sprites drawn
+// from it can share one draw call. Images are added first and packed by
+// build() onto shelves of pages of pageSize pixels, tallest first. Each
+// image is surrounded by padding pixels copying its border, so filtering
+// never samples a neighbour.
+//
+// An image larger than a page gets a page of its own size.
+class TextureAtlas {
+public:
+  explicit TextureAtlas(int pageSize = 2048, int padding = 1)
+      : pageSize_(pageSize), padding_(padding) {}
+  ~TextureAtlas() { unload(); }
+
+  TextureAtlas(const TextureAtlas &) = delete;
+  TextureAtlas &operator=(const TextureAtlas &) = delete;
+
+  // Copies image, converted to RGBA, and returns the index of its region.
+  // The region is valid once build() returned true.
+  uint32_t add(const Image &image);
+
+  // Packs the added images and uploads the pages. Call once, on the main
+  // thread. Returns false if an image was empty or a page could not be
+  // uploaded.
+  bool build();
+
+  const AtlasRegion &region(uint32_t index) const { return regions_[index]; }
+  const Texture2D &page(uint32_t index) const { return pages_[index]; }
+  size_t pageCount() const { return pages_.size(); }
+
+  // Unloads the pages and drops all images. The pages live on the GPU, so
+  // this needs the GL context of the window.
+  void unload();
+
+private:
+  int pageSize_;
+  int padding_;
+  std::vector<Image> images_; // Until build().
+  std::vector<AtlasRegion> regions_;
+  std::vector<Texture2D> pages_;
+};
@@ -0,0 +1,211 @@
+#include "tween.h"
+#include <algorithm>
+#include <cmath>
+#include <span>
+
+TweenId TweenScheduler::add(float *target, float from, float to,
+                            float duration, Ease curve, float delay) {
+  TweenId id = allocate(target, from, to, duration, curve, delay);
+  start(id.index);
+  return id;
+}
+
+TweenId TweenScheduler::then(TweenId previous, float *target, float from,
+                             float to, float duration, Ease curve,
+                             float delay) {
+  if (find(previous) == nullptr) {
+    return add(target, from, to, duration, curve, delay);
+  }
+  uint32_t last = previous.index;
+  while (find(slots_[last].next) != nullptr) {
+    last = slots_[last].next.index;
+  }
+  TweenId id = allocate(target, from, to, duration, curve, delay);
+  slots_[last].next = id;
+  return id;
+}
+
+void TweenScheduler::onFinish(TweenId id, Callback callback, void *user) {
+  if (find(id) != nullptr) {
+    slots_[id.index].callback = callback;
+    slots_[id.index].user = user;
+  }
+}
+
+void TweenScheduler::cancel(TweenId id) {
+  // Unlike find(), this also takes a finished tween whose callback is
+  // still due.
+  if (id.index >= slots_.size() ||
+      slots_[id.index].generation != id.generation ||
+      slots_[id.index].state == State::Free) {
+    return;
+  }
+  uint32_t index = id.index;
+  while (true) {
+    Slot &slot = slots_[index];
+    TweenId next = slot.next;
+    if (slot.state == State::Running) {
+      remove(pools_[(size_t)slot.curve], slot.position);
+    }
+    release(index);
+    if (find(next) == nullptr) {
+      return;
+    }
+    index = next.index;
+  }
+}
+
+bool TweenScheduler::alive(TweenId id) const { return find(id) != nullptr; }
+
+size_t TweenScheduler::size() const {
+  size_t count = 0;
+  for (const Pool &pool : pools_) {
+    count += pool.slot.size();
+  }
+  return count;
+}
+
+void TweenScheduler::update(float dt) {
+  for (size_t curve = 0; curve < pools_.size(); curve++) {
+    Pool &pool = pools_[curve];
+    size_t n = pool.slot.size();
+    if (n == 0) {
+      continue;
+    }
+    if (progress_.size() < n) {
+      progress_.resize(n);
+    }
+    float *elapsed = pool.elapsed.data();
+    const float *inverseDuration = pool.inverseDuration.data();
+    const float *from = pool.from.data();
+    const float *delta = pool.delta.data();
+    float *const *target = pool.target.data();
+    float *progress = progress_.data();
+
+    uint32_t finishing = 0;
+    for (size_t i = 0; i < n; i++) {
+      elapsed[i] += dt;
+      progress[i] = elapsed[i] * inverseDuration[i];
+      finishing += progress[i] >= 1.0f;
+    }
+    ease((Ease)curve, std::span<const float>(progress, n),
+         std::span<float>(progress, n));
+    for (size_t i = 0; i < n; i++) {
+      if (elapsed[i] >= 0.0f) {
+        *target[i] = from[i] + delta[i] * progress[i];
+      }
+    }
+
+    if (finishing == 0) {
+      continue;
+    }
+    // Backwards, so a swapped in tween was already checked.
+    for (size_t i = n; i-- > 0;) {
+      if (elapsed[i] * inverseDuration[i] >= 1.0f) {
+        uint32_t index = pool.slot[i];
+        *slots_[index].target = slots_[index].to;
+        slots_[index].state = State::Finished;
+        finished_.push_back(index);
+        remove(pool, (uint32_t)i);
+      }
+    }
+  }
+
+  // Callbacks may add and cancel tweens, so they run once the pools are
+  // done. A finished tween cancelled by an earlier callback is skipped.
+  for (size_t i = 0; i < finished_.size(); i++) {
+    uint32_t index = finished_[i];
+    Slot &slot = slots_[index];
+    if (slot.state != State::Finished) {
+      continue;
+    }
+    TweenId id = {index, slot.generation};
+    TweenId next = slot.next;
+    Callback callback = slot.callback;
+    void *user = slot.user;
+    release(index);
+    if (find(next) != nullptr) {
+      start(next.index);
+    }
+    if (callback != nullptr) {
+      callback(user, id);
+    }
+  }
+  finished_.clear();
+}
+
+TweenId TweenScheduler::allocate(float *target, float from, float to,
+                                 float duration, Ease curve, float delay) {
+  uint32_t index;
+  if (!freeSlots_.empty()) {
+    index = freeSlots_.back();
+    freeSlots_.pop_back();
+  } else {
+    index = (uint32_t)slots_.size();
+    slots_.emplace_back();
+  }
+  Slot &slot = slots_[index];
+  slot.state = State::Waiting;
+  slot.curve = curve;
+  slot.target = target;
+  slot.from = from;
+  slot.to = to;
+  slot.duration = duration;
+  slot.delay = delay;
+  slot.next = {};
+  slot.callback = nullptr;
+  slot.user = nullptr;
+  return {index, slot.generation};
+}
+
+void TweenScheduler::start(uint32_t index) {
+  Slot &slot = slots_[index];
+  Pool &pool = pools_[(size_t)slot.curve];
+  float from = std::isnan(slot.from) ? *slot.target : slot.from;
+  slot.state = State::Running;
+  slot.position = (uint32_t)pool.slot.size();
+  pool.elapsed.push_back(-slot.delay);
+  // A zero duration finishes on the next update that advances time.
+  pool.inverseDuration.push_back(slot.duration > 0.0f
+                                     ? 1.0f / slot.duration
+                                     : std::numeric_limits<float>::max());
+  pool.from.push_back(from);
+  pool.delta.push_back(slot.to - from);
+  pool.target.push_back(slot.target);
+  pool.slot.push_back(index);
+}
+
+void TweenScheduler::remove(Pool &pool, uint32_t position) {
+  uint32_t last = (uint32_t)pool.slot.size() - 1;
+  if (position != last) {
+    pool.elapsed[position] = pool.elapsed[last];
+    pool.inverseDuration[position] = pool.inverseDuration[last];
+    pool.from[position] = pool.from[last];
+    pool.delta[position] = pool.delta[last];
+    pool.target[position] = pool.target[last];
+    pool.slot[position] = pool.slot[last];
+    slots_[pool.slot[position]].position = position;
+  }
+  pool.elapsed.pop_back();
+  pool.inverseDuration.pop_back();
+  pool.from.pop_back();
+  pool.delta.pop_back();
+  pool.target.pop_back();
+  pool.slot.pop_back();
+}
+
+void TweenScheduler::release(uint32_t index) {
+  Slot &slot = slots_[index];
+  slot.state = State::Free;
+  slot.generation++;
+  freeSlots_.push_back(index);
+}
+
+const TweenScheduler::Slot *TweenScheduler::find(TweenId id) const {
+  if (id.index >= slots_.size()) {
+    return nullptr;
+  }
+  const Slot &slot = slots_[id.index];
+  bool live = slot.state == State::Waiting || slot.state == State::Running;
+  return live && slot.generation == id.generation ? &slot : nullptr;
+}
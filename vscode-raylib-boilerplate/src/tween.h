@@ -0,0 +1,105 @@
+#pragma once
+#include "easing.h"
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Identifies a tween of a TweenScheduler. It goes stale once the tween has
+// finished or was cancelled, and a stale id is ignored by all calls.
+struct TweenId {
+  uint32_t index = UINT32_MAX;
+  uint32_t generation = 0;
+};
+
+// TweenScheduler animates floats from one value to another over time. The
+// running tweens are stored as structure of arrays, one pool per easing
+// curve, and update() advances each pool in one batched pass: elapsed time,
+// progress and easing run in vectorizable loops, only the final write goes
+// through each tween's target pointer. Finished tweens are swap-removed.
+//
+// Tweens can be chained, the next one starts when the previous finishes,
+// and can call a function when they finish. Neither allocates per tween,
+// the pools and the slot table only grow to the peak tween count.
+//
+// A target must stay valid until its tween finished or was cancelled.
+class TweenScheduler {
+public:
+  // Called with the user pointer given to onFinish and the finished tween.
+  using Callback = void (*)(void *user, TweenId id);
+
+  // Pass as from to start at the value the target has when the tween
+  // starts, for example at the end of the previous tween of a chain.
+  static constexpr float kCurrent = std::numeric_limits<float>::quiet_NaN();
+
+  // Animates *target from from to to over duration seconds, after delay
+  // seconds. The target keeps its value during the delay.
+  TweenId add(float *target, float from, float to, float duration,
+              Ease curve = Ease::Linear, float delay = 0.0f);
+
+  // Like add, but starts once previous finishes. If previous is not
+  // running, starts now. If previous already has a successor, this starts
+  // after the last tween of that chain.
+  TweenId then(TweenId previous, float *target, float from, float to,
+               float duration, Ease curve = Ease::Linear, float delay = 0.0f);
+
+  // Calls callback(user, id) when the tween finishes, not when it is
+  // cancelled. Replaces an earlier callback.
+  void onFinish(TweenId id, Callback callback, void *user = nullptr);
+
+  // Stops the tween where it is, along with the tweens chained after it.
+  void cancel(TweenId id);
+
+  // True while the tween is waiting in a chain or running.
+  bool alive(TweenId id) const;
+
+  // Advances all tweens by dt seconds and writes their targets. Callbacks
+  // run at the end and may add or cancel tweens.
+  void update(float dt);
+
+  // The count of running tweens, not counting those waiting in a chain.
+  size_t size() const;
+
+private:
+  // Finished lasts from the end of the pool pass to its callback.
+  enum class State : uint8_t { Free, Waiting, Running, Finished };
+
+  // Slot holds what is only needed to start and finish a tween.
+  struct Slot {
+    uint32_t generation = 0;
+    State state = State::Free;
+    Ease curve = Ease::Linear;
+    uint32_t position = 0; // In the pool of its curve, while running.
+    float *target = nullptr;
+    float from = 0.0f;
+    float to = 0.0f;
+    float duration = 0.0f;
+    float delay = 0.0f;
+    TweenId next;
+    Callback callback = nullptr;
+    void *user = nullptr;
+  };
+
+  // Pool holds the running tweens of one curve.
+  struct Pool {
+    std::vector<float> elapsed; // Negative during the delay.
+    std::vector<float> inverseDuration;
+    std::vector<float> from;
+    std::vector<float> delta;
+    std::vector<float *> target;
+    std::vector<uint32_t> slot;
+  };
+
+  TweenId allocate(float *target, float from, float to, float duration,
+                   Ease curve, float delay);
+  void start(uint32_t slot);
+  void remove(Pool &pool, uint32_t position);
+  void release(uint32_t slot);
+  const Slot *find(TweenId id) const;
+
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> freeSlots_;
+  std::array<Pool, (size_t)Ease::Count> pools_;
+  std::vector<float> progress_; // Scratch for update().
+  std::vector<uint32_t> finished_;
+};
@@ -0,0 +1,194 @@
+// Packs a directory into one asset archive (see src/asset_archive.h).
+//
+// Usage: asset_packer [--decode] <output> <directory>
+//
+// With --decode, images are stored as RGBA pixels and sounds as PCM
+// samples, so they need no decoding at runtime. Other files, and files that
+// raylib cannot decode, are stored as they are.
+#include "../src/asset_archive.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// A file to pack, with its payload once loaded.
+struct PackedFile {
+  std::string name;
+  AssetArchiveEntry entry;
+  std::vector<unsigned char> data;
+};
+
+bool isImage(std::string_view extension) {
+  return extension == ".png" || extension == ".bmp" || extension == ".tga" ||
+         extension == ".jpg" || extension == ".gif" || extension == ".qoi";
+}
+
+bool isSound(std::string_view extension) {
+  return extension == ".wav" || extension == ".ogg" || extension == ".mp3" ||
+         extension == ".flac" || extension == ".qoa";
+}
+
+// Fills in the payload of file, decoded if requested and possible.
+bool load(const fs::path &path, bool decode, PackedFile &file) {
+  std::string extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](unsigned char c) { return (char)std::tolower(c); });
+
+  if (decode && isImage(extension)) {
+    Image image = LoadImage(path.string().c_str());
+    if (image.data != nullptr) {
+      ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+      auto *pixels = (const unsigned char *)image.data;
+      file.data.assign(pixels, pixels + GetPixelDataSize(image.width,
+                                                         image.height,
+                                                         image.format));
+      file.entry.payload = AssetPayload::Image;
+      file.entry.meta[0] = (uint32_t)image.width;
+      file.entry.meta[1] = (uint32_t)image.height;
+      file.entry.meta[2] = (uint32_t)image.format;
+      UnloadImage(image);
+      return true;
+    }
+  } else if (decode && isSound(extension)) {
+    Wave wave = LoadWave(path.string().c_str());
+    if (wave.data != nullptr) {
+      auto *samples = (const unsigned char *)wave.data;
+      file.data.assign(samples, samples + (size_t)wave.frameCount *
+                                              wave.channels *
+                                              (wave.sampleSize / 8));
+      file.entry.payload = AssetPayload::Wave;
+      file.entry.meta[0] = wave.frameCount;
+      file.entry.meta[1] = wave.sampleRate;
+      file.entry.meta[2] = wave.sampleSize;
+      file.entry.meta[3] = wave.channels;
+      UnloadWave(wave);
+      return true;
+    }
+  }
+
+  std::ifstream in(path, std::ios::binary);
+  file.data.assign(std::istreambuf_iterator<char>(in), {});
+  file.entry.payload = AssetPayload::File;
+  return (bool)in || in.eof();
+}
+
+uint64_t alignUp(uint64_t value) {
+  return (value + kAssetArchiveAlignment - 1) / kAssetArchiveAlignment *
+         kAssetArchiveAlignment;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bool decode = false;
+  std::vector<std::string_view> arguments;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--decode") == 0) {
+      decode = true;
+    } else {
+      arguments.push_back(argv[i]);
+    }
+  }
+  if (arguments.size() != 2) {
+    std::fprintf(stderr, "Usage: %s [--decode] <output> <directory>\n",
+                 argv[0]);
+    return 2;
+  }
+  fs::path output(arguments[0]);
+  fs::path directory(arguments[1]);
+
+  SetTraceLogLevel(LOG_WARNING);
+
+  // The error_code overloads, so a missing or unreadable directory is
+  // reported instead of ending in an uncaught filesystem_error.
+  std::vector<PackedFile> files;
+  std::error_code error;
+  fs::recursive_directory_iterator items(directory, error);
+  for (; !error && items != fs::recursive_directory_iterator();
+       items.increment(error)) {
+    const fs::directory_entry &item = *items;
+    std::error_code status;
+    if (!item.is_regular_file(status)) {
+      continue;
+    }
+    PackedFile file;
+    file.name = item.path().lexically_relative(directory).generic_string();
+    if (!load(item.path(), decode, file)) {
+      std::fprintf(stderr, "Cannot read %s\n", item.path().string().c_str());
+      return 1;
+    }
+    files.push_back(std::move(file));
+  }
+  if (error) {
+    std::fprintf(stderr, "Cannot read %s: %s\n", directory.string().c_str(),
+                 error.message().c_str());
+    return 1;
+  }
+  // Sorted, so the runtime can binary search the index.
+  std::sort(files.begin(), files.end(),
+            [](const PackedFile &a, const PackedFile &b) {
+              return a.name < b.name;
+            });
+
+  // Lay out the names, then the aligned payloads.
+  AssetArchiveHeader header;
+  header.entryCount = (uint32_t)files.size();
+  std::string names;
+  for (PackedFile &file : files) {
+    file.entry.nameOffset = (uint32_t)names.size();
+    file.entry.nameLength = (uint32_t)file.name.size();
+    names += file.name;
+  }
+  uint64_t offset = alignUp(sizeof(header) +
+                            files.size() * sizeof(AssetArchiveEntry) +
+                            names.size());
+  for (PackedFile &file : files) {
+    file.entry.offset = offset;
+    file.entry.size = file.data.size();
+    offset = alignUp(offset + file.data.size());
+  }
+
+  fs::path temporary = output;
+  temporary += ".tmp";
+  bool written;
+  {
+    std::ofstream out(temporary, std::ios::binary);
+    out.write((const char *)&header, sizeof(header));
+    for (const PackedFile &file : files) {
+      out.write((const char *)&file.entry, sizeof(file.entry));
+    }
+    out.write(names.data(), (std::streamsize)names.size());
+    for (const PackedFile &file : files) {
+      std::vector<char> padding((size_t)(file.entry.offset - out.tellp()), 0);
+      out.write(padding.data(), (std::streamsize)padding.size());
+      out.write((const char *)file.data.data(),
+                (std::streamsize)file.data.size());
+    }
+    written = (bool)out;
+  }
+  if (!written) {
+    std::fprintf(stderr, "Cannot write %s\n", temporary.string().c_str());
+    fs::remove(temporary, error);
+    return 1;
+  }
+  fs::rename(temporary, output, error);
+  if (error) {
+    std::fprintf(stderr, "Cannot write %s: %s\n", output.string().c_str(),
+                 error.message().c_str());
+    fs::remove(temporary, error);
+    return 1;
+  }
+
+  std::printf("Packed %zu files into %s (%llu bytes)\n", files.size(),
+              output.string().c_str(), (unsigned long long)offset);
+  return 0;
+}